@@ -0,0 +1,256 @@
+// MiControlMap.cpp
+#include "MiControlMap.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+using namespace stk;
+
+// names used in mapping files, in PARAM_ order
+static const char* paramNames[NUM_PARAMS] = {
+    "harmonics",
+    "osc1Shape", "osc2Shape", "osc3Shape",
+    "osc1Volume", "osc2Volume", "osc3Volume",
+    "osc1Tuning", "osc2Tuning", "osc3Tuning",
+    "filterCutoff", "filterResonance", "filterMix",
+    "filterType", "filterKeyTrack", "filterEnvAmount",
+    "echoFeedback", "echoLength", "echoMix",
+    "reverbSize", "reverbType", "reverbMix",
+    "tremeloFrequency", "tremeloDepth", "tremeloMix",
+    "panFrequency", "panDepth", "panMix",
+    "attack", "decay", "sustain", "release", "envelopeCurve",
+    "volume"
+};
+
+// names used in mapping files, in CURVE_ order
+static const char* curveNames[NUM_CURVES] = {
+    "linear", "knob", "square", "fraction", "level", "step", "cc"
+};
+
+// names used in mapping files, in layout order
+static const char* layoutNames[MIDI_LAYOUTS] = { "knobule", "akai" };
+
+//-----------------------------------------------------------------------------
+// name: MiControlMap()
+// desc: constructor, starts with the built in mappings
+//-----------------------------------------------------------------------------
+MiControlMap::MiControlMap() {
+    setDefaults();
+}
+
+//-----------------------------------------------------------------------------
+// name: load()
+// desc: replace the mappings with the ones in a mapping file.  Returns false,
+//       keeping the current mappings, if the file can't be read or has a bad
+//       line (which is reported).
+//-----------------------------------------------------------------------------
+bool MiControlMap::load(const std::string& path) {
+    std::ifstream file(path.c_str());
+    if (!file) return false;
+
+    // build the new table on the side so a bad file changes nothing
+    MiControlMap* loaded = new MiControlMap();
+    loaded->clear();
+
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); lineNumber++) {
+        // comments run to the end of the line
+        std::string::size_type hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream fields(line);
+        std::string layoutName, paramName, curveName;
+        int cc;
+        StkFloat low, high;
+        if (!(fields >> layoutName)) continue;
+
+        int layout = findLayout(layoutName);
+        int param = -1;
+        int curve = -1;
+        if (fields >> cc >> paramName >> curveName >> low >> high) {
+            param = findParam(paramName);
+            curve = findCurve(curveName);
+        }
+        if (layout < 0 || param < 0 || curve < 0
+            || !loaded->add(layout, cc, param, curve, low, high)) {
+            std::cerr << "MiControlMap: bad mapping on line " << lineNumber
+                      << " of " << path << ", keeping the current mappings\n";
+            delete loaded;
+            return false;
+        }
+    }
+
+    *this = *loaded;
+    delete loaded;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: setDefaults()
+// desc: the built in mappings for the knobule + soundstick and the akai
+//-----------------------------------------------------------------------------
+void MiControlMap::setDefaults() {
+    clear();
+
+    add(KNOBULE_LAYOUT, 0, PARAM_HARMONICS, CURVE_STEP, 0.0, 15.0);
+    add(KNOBULE_LAYOUT, 1, PARAM_OSC1_SHAPE, CURVE_STEP, 0.0, 3.0);
+    add(KNOBULE_LAYOUT, 2, PARAM_OSC1_VOLUME, CURVE_LEVEL, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 3, PARAM_OSC2_TUNING, CURVE_LINEAR, 0.5, 2.0);
+    add(KNOBULE_LAYOUT, 4, PARAM_OSC2_SHAPE, CURVE_STEP, 0.0, 3.0);
+    add(KNOBULE_LAYOUT, 5, PARAM_OSC2_VOLUME, CURVE_LEVEL, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 6, PARAM_OSC3_TUNING, CURVE_LINEAR, 0.5, 2.0);
+    add(KNOBULE_LAYOUT, 7, PARAM_OSC3_SHAPE, CURVE_STEP, 0.0, 3.0);
+    add(KNOBULE_LAYOUT, 8, PARAM_OSC3_VOLUME, CURVE_LEVEL, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 9, PARAM_FILTER_CUTOFF, CURVE_CC, 0.0, 127.0);
+    add(KNOBULE_LAYOUT, 10, PARAM_FILTER_RESONANCE, CURVE_CC, 0.0, 127.0);
+    add(KNOBULE_LAYOUT, 11, PARAM_FILTER_MIX, CURVE_LEVEL, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 12, PARAM_ECHO_FEEDBACK, CURVE_KNOB, 0.0, 1.0);
+    // echo length in seconds
+    add(KNOBULE_LAYOUT, 13, PARAM_ECHO_LENGTH, CURVE_FRACTION, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 14, PARAM_ECHO_MIX, CURVE_LEVEL, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 15, PARAM_REVERB_SIZE, CURVE_STEP, 0.1, 7.1);
+    add(KNOBULE_LAYOUT, 16, PARAM_REVERB_TYPE, CURVE_STEP, 0.0, 3.0);
+    add(KNOBULE_LAYOUT, 17, PARAM_REVERB_MIX, CURVE_LEVEL, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 18, PARAM_TREMELO_FREQUENCY, CURVE_KNOB, 0.25, 13.25);
+    add(KNOBULE_LAYOUT, 19, PARAM_TREMELO_DEPTH, CURVE_KNOB, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 20, PARAM_PAN_MIX, CURVE_FRACTION, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 21, PARAM_PAN_FREQUENCY, CURVE_KNOB, 0.25, 13.25);
+    add(KNOBULE_LAYOUT, 22, PARAM_ATTACK, CURVE_SQUARE, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 23, PARAM_DECAY, CURVE_SQUARE, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 24, PARAM_RELEASE, CURVE_SQUARE, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 25, PARAM_TREMELO_MIX, CURVE_FRACTION, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 26, PARAM_PAN_DEPTH, CURVE_KNOB, 0.0, 1.0);
+    // the master volume knob (top right) moves the sustain along with it
+    add(KNOBULE_LAYOUT, 27, PARAM_VOLUME, CURVE_KNOB, 0.0, 1.0);
+    add(KNOBULE_LAYOUT, 27, PARAM_SUSTAIN, CURVE_SQUARE, 0.0, 1.0);
+    // sustain, out of order to be replaced by a slider
+    add(KNOBULE_LAYOUT, 28, PARAM_SUSTAIN, CURVE_SQUARE, 0.0, 1.0);
+    // envelope curve, linear or exponential
+    add(KNOBULE_LAYOUT, 29, PARAM_ENVELOPE_CURVE, CURVE_STEP, 0.0, 1.0);
+
+    // mod wheel, filter cutoff
+    add(AKAIMPK_LAYOUT, 1, PARAM_FILTER_CUTOFF, CURVE_CC, 0.0, 127.0);
+    add(AKAIMPK_LAYOUT, 2, PARAM_OSC1_SHAPE, CURVE_STEP, 0.0, 3.0);
+    add(AKAIMPK_LAYOUT, 3, PARAM_OSC2_SHAPE, CURVE_STEP, 0.0, 3.0);
+    add(AKAIMPK_LAYOUT, 4, PARAM_OSC3_SHAPE, CURVE_STEP, 0.0, 3.0);
+    add(AKAIMPK_LAYOUT, 5, PARAM_ATTACK, CURVE_SQUARE, 0.0, 1.0);
+    add(AKAIMPK_LAYOUT, 6, PARAM_DECAY, CURVE_SQUARE, 0.0, 1.0);
+    add(AKAIMPK_LAYOUT, 7, PARAM_SUSTAIN, CURVE_SQUARE, 0.0, 1.0);
+    add(AKAIMPK_LAYOUT, 8, PARAM_RELEASE, CURVE_SQUARE, 0.0, 1.0);
+}
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: unmap every controller
+//-----------------------------------------------------------------------------
+void MiControlMap::clear() {
+    for (int layout = 0; layout < MIDI_LAYOUTS; layout++)
+        for (int cc = 0; cc < MIDI_CONTROLLERS; cc++)
+            m_numControls[layout][cc] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// name: add()
+// desc: make controller cc drive param in a layout, as well as whatever it
+//       drives already.  Returns false if anything is out of range or cc
+//       already drives CONTROL_TARGETS_MAX parameters.
+//-----------------------------------------------------------------------------
+bool MiControlMap::add(int layout, int cc, int param, int curve, StkFloat low, StkFloat high) {
+    if (layout < 0 || layout >= MIDI_LAYOUTS) return false;
+    if (cc < 0 || cc >= MIDI_CONTROLLERS) return false;
+    if (param < 0 || param >= NUM_PARAMS) return false;
+    if (curve < 0 || curve >= NUM_CURVES) return false;
+
+    int& numControls = m_numControls[layout][cc];
+    if (numControls == CONTROL_TARGETS_MAX) return false;
+
+    MiControl& control = m_controls[layout][cc][numControls++];
+    control.param = param;
+    control.curve = curve;
+    control.low = low;
+    control.high = high;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: getNumControls()
+// desc: get the number of parameters controller cc drives in a layout
+//-----------------------------------------------------------------------------
+int MiControlMap::getNumControls(int layout, int cc) {
+    if (layout < 0 || layout >= MIDI_LAYOUTS) return 0;
+    if (cc < 0 || cc >= MIDI_CONTROLLERS) return 0;
+    return m_numControls[layout][cc];
+}
+
+//-----------------------------------------------------------------------------
+// name: getControl()
+// desc: get one of the parameters controller cc drives in a layout
+//-----------------------------------------------------------------------------
+const MiControl& MiControlMap::getControl(int layout, int cc, int index) {
+    return m_controls[layout][cc][index];
+}
+
+//-----------------------------------------------------------------------------
+// name: scale()
+// desc: map a controller value (0-127) onto a control's parameter
+//-----------------------------------------------------------------------------
+StkFloat MiControlMap::scale(const MiControl& control, int value) {
+    StkFloat range = control.high - control.low;
+    switch (control.curve) {
+      case CURVE_LINEAR:
+        return control.low + range * (value / 127.0);
+      case CURVE_KNOB:
+        return control.low + range * (StkFloat)(value+1) / 130.0;
+      case CURVE_SQUARE: {
+        StkFloat x = (StkFloat)(value+1) / 130.0;
+        return control.low + range * (x * x);
+      }
+      case CURVE_FRACTION:
+        return control.low + range * ((StkFloat)value / 128.0);
+      case CURVE_LEVEL:
+        // the bottom of the knob is exactly low, so the synth can drop
+        // whatever the knob controls
+        if (value == 0) return control.low;
+        return control.low + range * ((StkFloat)(value+1) / 130.0);
+      case CURVE_STEP: {
+        int steps = (int) floor(range + 0.5) + 1;
+        if (steps < 1) steps = 1;
+        int step = value * steps / MIDI_CONTROLLERS;
+        return control.low + step;
+      }
+      case CURVE_CC:
+      default:
+        return (StkFloat) value;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: findParam()
+// desc: get the parameter a mapping file name means, or -1
+//-----------------------------------------------------------------------------
+int MiControlMap::findParam(const std::string& name) {
+    for (int i = 0; i < NUM_PARAMS; i++)
+        if (name == paramNames[i]) return i;
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+// name: findCurve()
+// desc: get the curve a mapping file name means, or -1
+//-----------------------------------------------------------------------------
+int MiControlMap::findCurve(const std::string& name) {
+    for (int i = 0; i < NUM_CURVES; i++)
+        if (name == curveNames[i]) return i;
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+// name: findLayout()
+// desc: get the layout a mapping file name means, or -1
+//-----------------------------------------------------------------------------
+int MiControlMap::findLayout(const std::string& name) {
+    for (int i = 0; i < MIDI_LAYOUTS; i++)
+        if (name == layoutNames[i]) return i;
+    return -1;
+}
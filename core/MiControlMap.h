@@ -0,0 +1,118 @@
+#ifndef MI_CONTROL_MAP_H
+#define MI_CONTROL_MAP_H
+
+#include "Stk.h"
+#include <string>
+
+using namespace stk;
+
+// knob layouts, which controller numbers drive which parameters
+#define KNOBULE_LAYOUT 0
+#define AKAIMPK_LAYOUT 1
+#define MIDI_LAYOUTS 2
+
+// controller numbers, and most parameters one controller can drive
+#define MIDI_CONTROLLERS 128
+#define CONTROL_TARGETS_MAX 4
+
+// parameters a knob can drive
+enum {
+    PARAM_HARMONICS,
+    PARAM_OSC1_SHAPE,
+    PARAM_OSC2_SHAPE,
+    PARAM_OSC3_SHAPE,
+    PARAM_OSC1_VOLUME,
+    PARAM_OSC2_VOLUME,
+    PARAM_OSC3_VOLUME,
+    PARAM_OSC1_TUNING,
+    PARAM_OSC2_TUNING,
+    PARAM_OSC3_TUNING,
+    PARAM_FILTER_CUTOFF,
+    PARAM_FILTER_RESONANCE,
+    PARAM_FILTER_MIX,
+    PARAM_FILTER_TYPE,
+    PARAM_FILTER_KEY_TRACK,
+    PARAM_FILTER_ENV_AMOUNT,
+    PARAM_ECHO_FEEDBACK,
+    PARAM_ECHO_LENGTH,
+    PARAM_ECHO_MIX,
+    PARAM_REVERB_SIZE,
+    PARAM_REVERB_TYPE,
+    PARAM_REVERB_MIX,
+    PARAM_TREMELO_FREQUENCY,
+    PARAM_TREMELO_DEPTH,
+    PARAM_TREMELO_MIX,
+    PARAM_PAN_FREQUENCY,
+    PARAM_PAN_DEPTH,
+    PARAM_PAN_MIX,
+    PARAM_ATTACK,
+    PARAM_DECAY,
+    PARAM_SUSTAIN,
+    PARAM_RELEASE,
+    PARAM_ENVELOPE_CURVE,
+    PARAM_VOLUME,
+    NUM_PARAMS
+};
+
+// how a knob's 0-127 is spread over a parameter's low to high
+enum {
+    CURVE_LINEAR,   // value / 127
+    CURVE_KNOB,     // (value + 1) / 130, never quite reaching either end
+    CURVE_SQUARE,   // the knob curve squared, finer at the bottom
+    CURVE_FRACTION, // value / 128
+    CURVE_LEVEL,    // the knob curve, but exactly low at the bottom
+    CURVE_STEP,     // whole steps from low up to high
+    CURVE_CC,       // the raw controller value, for parameters that scale it
+    NUM_CURVES
+};
+
+//-----------------------------------------------------------------------------
+// name: struct MiControl
+// desc: one parameter driven by a knob, and how the knob is scaled onto it
+//-----------------------------------------------------------------------------
+struct MiControl {
+    int param;
+    int curve;
+    StkFloat low;
+    StkFloat high;
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiControlMap
+// desc: which parameters each controller number drives in each layout, as a
+//       table looked up by layout and controller number.  Starts out with
+//       the built in knob mappings of the knobule + soundstick and the akai
+//       mpk mini; load() replaces them with a mapping file of lines like
+//
+//           # layout  cc  parameter     curve   low  high
+//           knobule   9   filterCutoff  cc      0    127
+//           akai      5   attack        square  0    1
+//
+//       Parameter and curve names are the PARAM_ and CURVE_ names in camel
+//       case.  A controller can be listed more than once to drive several
+//       parameters.
+//-----------------------------------------------------------------------------
+class MiControlMap {
+public:
+    // constructor
+    MiControlMap();
+
+public:
+    bool load(const std::string& path);
+    void setDefaults();
+    void clear();
+    bool add(int layout, int cc, int param, int curve, StkFloat low, StkFloat high);
+    int getNumControls(int layout, int cc);
+    const MiControl& getControl(int layout, int cc, int index);
+
+    static StkFloat scale(const MiControl& control, int value);
+    static int findParam(const std::string& name);
+    static int findCurve(const std::string& name);
+    static int findLayout(const std::string& name);
+
+private:
+    MiControl m_controls[MIDI_LAYOUTS][MIDI_CONTROLLERS][CONTROL_TARGETS_MAX];
+    int m_numControls[MIDI_LAYOUTS][MIDI_CONTROLLERS];
+};
+
+#endif
@@ -0,0 +1,665 @@
+// MiEngine.cpp
+#include "MiEngine.h"
+#include <cstring>
+
+using namespace stk;
+
+//-----------------------------------------------------------------------------
+// name: MiEngine()
+// desc: constructor, builds the parts in the engine's own context and arena.
+//       The caller's current context and arena are put back afterwards, so
+//       engines can be built on any thread.  lockMemory backs the arena
+//       with huge pages locked into RAM, for engines feeding an audio device.
+//       With more than one part, a worker thread is started for each core
+//       beyond the rendering thread, up to one per part.
+//-----------------------------------------------------------------------------
+MiEngine::MiEngine( int numVoices, StkFloat sampleRate, unsigned int blockSize, bool lockMemory, int numParts )
+    : m_context(sampleRate, blockSize) {
+    if (numParts < 1) numParts = 1;
+    if (numParts > MIDI_CHANNELS) numParts = MIDI_CHANNELS;
+
+    StkContext* previousContext = StkContext::current();
+    StkArena* previousArena = StkArena::current();
+
+    // each part's voices, oscillators and delay lines sit together in memory
+    // (plus its stereo buffer and its share of the pipeline)
+    size_t partSize = MiSynth::arenaSize(numVoices, sampleRate)
+                    + (PIPELINE_DEPTH_MAX + 3) * blockSize * sizeof(StkFloat);
+    m_arena = new StkArena(numParts * partSize + 2 * blockSize * sizeof(StkFloat), lockMemory, lockMemory);
+    StkContext::setCurrent(&m_context);
+    StkArena::setCurrent(m_arena);
+    m_parts.resize(numParts);
+    for (int i = 0; i < numParts; i++) {
+        Part& part = m_parts[i];
+        part.synth = m_arena->create<MiSynth>(numVoices);
+        // a single part renders straight into the caller's frames
+        if (numParts > 1) part.buffer.resize(blockSize, 2, 0.0);
+        part.synth->setPanMix(DEFAULT_PAN_MIX);
+        part.synth->setMasterVolume(DEFAULT_VOLUME);
+        part.pitchValue = 64;
+        part.nHarmonics = 0;
+
+        // the synth's envelope times
+        part.A = 0.01;
+        part.D = 0.2;
+        part.S = 0.5;
+        part.R = 0.5;
+
+        for (int p = 0; p < NUM_PARAMS; p++) part.pending[p] = false;
+        part.changed = false;
+    }
+    StkArena::setCurrent(previousArena);
+    StkContext::setCurrent(previousContext == &StkContext::defaultContext() ? NULL : previousContext);
+
+    m_pool = NULL;
+    if (numParts > 1) {
+        int numThreads = (int) std::thread::hardware_concurrency();
+        if (numThreads > numParts) numThreads = numParts;
+        if (numThreads > 1) m_pool = new MiRenderPool(numThreads - 1);
+    }
+
+    m_renderFrames = 0;
+    m_renderSlot = NULL;
+    m_volume = DEFAULT_VOLUME;
+    m_partVolume = DEFAULT_VOLUME;
+    m_layoutMode = KNOBULE_LAYOUT;
+    m_midiQueue = NULL;
+
+    m_pipelineDepth = 0;
+    m_produced = 0;
+    m_consumed = 0;
+    m_pipelinePosition = 0;
+    m_voiceWaiting = false;
+    m_pipelineQuit = false;
+}
+
+//-----------------------------------------------------------------------------
+// name: ~MiEngine()
+// desc: destructor
+//-----------------------------------------------------------------------------
+MiEngine::~MiEngine() {
+    stopPipeline();
+    delete m_pool;
+    for (unsigned int i = 0; i < m_parts.size(); i++) {
+        // the arena destroys the synth, unless it didn't fit
+        if (!m_arena->owns(m_parts[i].synth)) delete m_parts[i].synth;
+    }
+    // the part and pipeline buffers may live in the arena, so let them go first
+    m_parts.clear();
+    m_slots.clear();
+    m_pipelineOut = StkFrames();
+    delete m_arena;
+}
+
+//-----------------------------------------------------------------------------
+// name: tick()
+// desc: fill a stereo StkFrames with the parts, each with the master volume
+//       and its stereo pan applied.  A single part renders in place; several
+//       render block by block into their own buffers, in parallel, and are
+//       summed into frames.  Denormals are flushed to zero on the rendering
+//       threads so decaying reverb and filter tails don't spike the CPU once
+//       the synth goes quiet.  This is per-thread state, and cheap enough to
+//       (re)assert every buffer.
+//-----------------------------------------------------------------------------
+StkFrames& MiEngine::tick(StkFrames& frames) {
+    Stk::setDenormalFlush( true );
+
+    if (m_pipelineDepth > 0) return tickPipeline(frames);
+
+    drainMidi();
+    applyControls();
+
+    if (m_parts.size() == 1) {
+        m_parts[0].synth->tick(frames);
+        panPart(m_parts[0], frames);
+        return frames;
+    }
+
+    unsigned int nFrames = frames.frames();
+    unsigned int blockSize = m_context.blockSize();
+    for (unsigned int offset = 0; offset < nFrames; offset += blockSize) {
+        m_renderFrames = nFrames - offset;
+        if (m_renderFrames > blockSize) m_renderFrames = blockSize;
+
+        mixParts(&frames[offset * 2], m_renderFrames);
+    }
+    return frames;
+}
+
+//-----------------------------------------------------------------------------
+// name: mixParts()
+// desc: render every part's block of m_renderFrames, in parallel when there
+//       is a pool, and sum them into samples
+//-----------------------------------------------------------------------------
+void MiEngine::mixParts(StkFloat* samples, unsigned int nFrames) {
+    m_renderFrames = nFrames;
+    if (m_pool) m_pool->run((int) m_parts.size(), &renderPartTask, this);
+    else for (unsigned int i = 0; i < m_parts.size(); i++) renderPart(i);
+
+    // sum the parts
+    unsigned long n = nFrames * 2;
+    memcpy(samples, &m_parts[0].buffer[0], n * sizeof(StkFloat));
+    for (unsigned int i = 1; i < m_parts.size(); i++)
+        StkSimd::add(samples, &m_parts[i].buffer[0], n);
+}
+
+//-----------------------------------------------------------------------------
+// name: tickPipeline()
+// desc: tick() in pipeline mode, effects run a whole block at a time so the
+//       output is served out of the last finished block
+//-----------------------------------------------------------------------------
+StkFrames& MiEngine::tickPipeline(StkFrames& frames) {
+    unsigned int blockSize = m_context.blockSize();
+    unsigned int nFrames = frames.frames();
+    StkFloat* samples = &frames[0];
+    for (unsigned int written = 0; written < nFrames; ) {
+        if (m_pipelinePosition == blockSize) {
+            consumeBlock();
+            m_pipelinePosition = 0;
+        }
+        unsigned int n = blockSize - m_pipelinePosition;
+        if (n > nFrames - written) n = nFrames - written;
+        memcpy(samples + 2 * written, &m_pipelineOut[2 * m_pipelinePosition], 2 * n * sizeof(StkFloat));
+        m_pipelinePosition += n;
+        written += n;
+    }
+    return frames;
+}
+
+//-----------------------------------------------------------------------------
+// name: consumeBlock()
+// desc: run the effects stage of the oldest block from the voice thread into
+//       m_pipelineOut, then hand its slot back.  The voice thread is normally
+//       a block or more ahead; if it has fallen behind, wait for it.
+//-----------------------------------------------------------------------------
+void MiEngine::consumeBlock() {
+    unsigned long consumed = m_consumed.load(std::memory_order_relaxed);
+    while (m_produced.load(std::memory_order_acquire) == consumed)
+        std::this_thread::yield();
+
+    m_renderSlot = &m_slots[consumed % m_slots.size()];
+    mixParts(&m_pipelineOut[0], m_context.blockSize());
+    m_renderSlot = NULL;
+
+    // hand the slot back, and wake the voice thread if it's asleep on a
+    // full ring (a post never blocks)
+    m_consumed.store(consumed + 1);
+    if (m_voiceWaiting.exchange(false)) m_voiceWake.post();
+}
+
+//-----------------------------------------------------------------------------
+// name: voiceLoop()
+// desc: the voice thread in pipeline mode, renders each part's voice stage
+//       into the next free slot until the ring is full, then sleeps until
+//       the effects stage frees one
+//-----------------------------------------------------------------------------
+void MiEngine::voiceLoop() {
+    Stk::setDenormalFlush( true );
+
+    unsigned long numSlots = m_slots.size();
+    unsigned long produced = m_produced.load(std::memory_order_relaxed);
+    while (true) {
+        while (produced - m_consumed.load(std::memory_order_acquire) >= numSlots) {
+            // say we're going to sleep before the last look at the ring,
+            // so a slot freed after it is sure to see the flag and post
+            m_voiceWaiting.store(true);
+            if (m_pipelineQuit || produced - m_consumed.load() < numSlots) {
+                // no sleep after all, but if the flag was already taken
+                // its post is on the way and has to be used up
+                if (!m_voiceWaiting.exchange(false)) m_voiceWake.wait();
+                break;
+            }
+            m_voiceWake.wait();
+        }
+        if (m_pipelineQuit) return;
+
+        // notes and knobs act on the voice stage, so they are played here
+        drainMidi();
+        applyControls();
+        PipelineSlot& slot = m_slots[produced % numSlots];
+        for (unsigned int i = 0; i < m_parts.size(); i++)
+            slot.peak[i] = m_parts[i].synth->renderVoices(slot.mono[i]);
+        m_produced.store(++produced, std::memory_order_release);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: stopPipeline()
+// desc: stop and join the voice thread, back to rendering in one thread
+//-----------------------------------------------------------------------------
+void MiEngine::stopPipeline() {
+    if (m_voiceThread.joinable()) {
+        m_pipelineQuit = true;
+        if (m_voiceWaiting.exchange(false)) m_voiceWake.post();
+        m_voiceThread.join();
+    }
+    m_pipelineDepth = 0;
+}
+
+//-----------------------------------------------------------------------------
+// name: renderPartTask()
+// desc: MiRenderPool task, renders one part of the current block
+//-----------------------------------------------------------------------------
+void MiEngine::renderPartTask(void* engine, int index) {
+    ((MiEngine*) engine)->renderPart(index);
+}
+
+//-----------------------------------------------------------------------------
+// name: renderPart()
+// desc: render one part into its buffer, on whichever thread picked it up
+//-----------------------------------------------------------------------------
+void MiEngine::renderPart(int index) {
+    Stk::setDenormalFlush( true );
+
+    Part& part = m_parts[index];
+    StkFramesView block(part.buffer, 0, m_renderFrames);
+    // in pipeline mode the voice stage has already run, on the voice thread
+    if (m_renderSlot) part.synth->renderEffects(m_renderSlot->mono[index], m_renderSlot->peak[index], block);
+    else part.synth->tick(block);
+    panPart(part, block);
+}
+
+//-----------------------------------------------------------------------------
+// name: panPart()
+// desc: apply the master volume and a part's stereo pan to its frames, as
+//       the part's effects stage picked them up for this block
+//-----------------------------------------------------------------------------
+void MiEngine::panPart(Part& part, StkFrames& frames) {
+    StkFloat* samples = &frames[0];
+    StkFloat volume = part.synth->getMasterVolume();
+    StkFloat panMix = part.synth->getPanMix();
+    for (unsigned int frameIndex = 0; frameIndex < frames.frames(); frameIndex++) {
+        StkFloat2 tickSamp = { samples[0], samples[1] };
+        tickSamp *= volume;
+        StkFloat panLeft = 0.5 + 0.5 * part.synth->getStereoPan();
+        StkFloat2 pan = { panLeft, 1.0 - panLeft };
+        // pan the left and right channels of the synth together
+        tickSamp = panMix * (tickSamp * pan) + (1.0 - panMix) * tickSamp;
+        *samples++ = tickSamp[0];
+        *samples++ = tickSamp[1];
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: drainMidi()
+// desc: play the events waiting in the MIDI queue, sorted by arrival time
+//       since ports queue them from separate threads.  Events beyond
+//       MIDI_BLOCK_EVENTS wait for the next block.
+//-----------------------------------------------------------------------------
+void MiEngine::drainMidi() {
+    if (m_midiQueue == NULL) return;
+
+    int numEvents = 0;
+    while (numEvents < MIDI_BLOCK_EVENTS && m_midiQueue->pop(m_midiEvents[numEvents])) {
+        // insertion sort, the events are nearly in order already
+        MiMidiEvent event = m_midiEvents[numEvents];
+        int i = numEvents++;
+        for (; i > 0 && m_midiEvents[i - 1].time > event.time; i--)
+            m_midiEvents[i] = m_midiEvents[i - 1];
+        m_midiEvents[i] = event;
+    }
+
+    for (int i = 0; i < numEvents; i++)
+        processMidi(m_midiEvents[i].data, m_midiEvents[i].size);
+}
+
+//-----------------------------------------------------------------------------
+// name: setMidiQueue()
+// desc: play the events from queue (see MiMidiInput) as the engine renders,
+//       NULL stops.  Call it while the engine isn't rendering.
+//-----------------------------------------------------------------------------
+void MiEngine::setMidiQueue(MiMidiQueue* queue) {
+    m_midiQueue = queue;
+}
+
+//-----------------------------------------------------------------------------
+// name: processMidi()
+// desc: play one MIDI message held in a vector
+//-----------------------------------------------------------------------------
+void MiEngine::processMidi(const std::vector<unsigned char>& message) {
+    if (message.size() == 0) return;
+    processMidi(&message[0], (unsigned int) message.size());
+}
+
+//-----------------------------------------------------------------------------
+// name: processMidi()
+// desc: play one MIDI message on the part for its channel, knobs are mapped
+//       according to the layout mode and take effect at the next block.
+//       Other messages, and messages for channels without a part, are
+//       ignored (this runs on the audio thread, which mustn't print).
+//       Missing data bytes read as 0.
+//-----------------------------------------------------------------------------
+void MiEngine::processMidi(const unsigned char* bytes, unsigned int size) {
+    if (size == 0) return;
+    unsigned char message[3] = { bytes[0], 0, 0 };
+    for (unsigned int i = 1; i < size && i < 3; i++) message[i] = bytes[i];
+
+    // channel messages carry the channel in the low nibble
+    int status = (int)message[0];
+    unsigned int channel = 0;
+    if (status < 0xF0) {
+        channel = status & 0x0F;
+        status &= 0xF0;
+    }
+    if (channel >= m_parts.size()) status = 0;
+    Part& part = m_parts[channel < m_parts.size() ? channel : 0];
+
+    // Switch!  Based on status byte
+    switch (status) {
+      case NOTE_ON:
+        part.synth->noteOn((int)message[1], (int)message[2]);
+        break;
+
+      case NOTE_OFF:
+        part.synth->noteOff((int)message[1]);
+        break;
+
+      case CONTROL_CHANGE:
+        controlChange(part, (int)message[1], (int)message[2]);
+        break;
+
+      case PITCH_WHEEL:
+        // 14 bits, least significant first, centred on 8192
+        part.pitchValue = (int)message[2];
+        part.synth->setPitchBend((((int)message[2] << 7 | (int)message[1]) - 8192)
+                                 * PITCH_BEND_RANGE / 8192.0);
+        break;
+
+      default:
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: controlChange()
+// desc: note the new value of every parameter a knob drives in the current
+//       layout, they are applied by applyControls()
+//-----------------------------------------------------------------------------
+void MiEngine::controlChange(Part& part, int knobNumber, int intensity) {
+    int layout = m_layoutMode;
+    int numControls = m_controlMap.getNumControls(layout, knobNumber);
+    for (int i = 0; i < numControls; i++) {
+        const MiControl& control = m_controlMap.getControl(layout, knobNumber, i);
+        part.controls[control.param] = MiControlMap::scale(control, intensity);
+        part.pending[control.param] = true;
+        part.changed = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: applyControls()
+// desc: apply every part's pending knob values, and the master volume if
+//       it changed, once per block
+//-----------------------------------------------------------------------------
+void MiEngine::applyControls() {
+    for (unsigned int i = 0; i < m_parts.size(); i++)
+        if (m_parts[i].changed) applyControls(m_parts[i]);
+
+    StkFloat volume = m_volume.load(std::memory_order_relaxed);
+    if (volume != m_partVolume) {
+        m_partVolume = volume;
+        for (unsigned int i = 0; i < m_parts.size(); i++)
+            m_parts[i].synth->setMasterVolume(volume);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: applyControls()
+// desc: hand a part's pending knob values to its synth.  The envelope times
+//       go over together, so a sweep across all four sets them once.
+//-----------------------------------------------------------------------------
+void MiEngine::applyControls(Part& part) {
+    bool envelope = false;
+    for (int p = 0; p < NUM_PARAMS; p++) {
+        if (!part.pending[p]) continue;
+        part.pending[p] = false;
+
+        StkFloat value = part.controls[p];
+        switch (p) {
+          case PARAM_HARMONICS: // n harmonics for BLIT saw and square
+            if (part.nHarmonics != (int)value) {
+              part.nHarmonics = (int)value;
+              part.synth->setNHarmonics(part.nHarmonics);
+            }
+            break;
+          case PARAM_OSC1_SHAPE:
+          case PARAM_OSC2_SHAPE:
+          case PARAM_OSC3_SHAPE:
+            part.synth->setWaveShape(p - PARAM_OSC1_SHAPE, (int)value);
+            break;
+          case PARAM_OSC1_VOLUME:
+          case PARAM_OSC2_VOLUME:
+          case PARAM_OSC3_VOLUME:
+            part.synth->setOscVolume(p - PARAM_OSC1_VOLUME, value);
+            break;
+          case PARAM_OSC1_TUNING:
+          case PARAM_OSC2_TUNING:
+          case PARAM_OSC3_TUNING:
+            part.synth->setOscTuning(p - PARAM_OSC1_TUNING, value);
+            break;
+          case PARAM_FILTER_CUTOFF:
+            part.synth->setFilterCutoffCC((int)value);
+            break;
+          case PARAM_FILTER_RESONANCE:
+            part.synth->setFilterResonanceCC((int)value);
+            break;
+          case PARAM_FILTER_MIX:
+            part.synth->setFilterMix(value);
+            break;
+          case PARAM_FILTER_TYPE:
+            part.synth->setFilterType((int)value);
+            break;
+          case PARAM_FILTER_KEY_TRACK:
+            part.synth->setFilterKeyTrack(value);
+            break;
+          case PARAM_FILTER_ENV_AMOUNT:
+            part.synth->setFilterEnvAmount(value);
+            break;
+          case PARAM_ECHO_FEEDBACK:
+            part.synth->setEchoFeedback(value);
+            break;
+          case PARAM_ECHO_LENGTH: // in seconds
+            part.synth->setEchoLength((unsigned long)(m_context.sampleRate() * value));
+            break;
+          case PARAM_ECHO_MIX:
+            part.synth->setEchoMix(value);
+            break;
+          case PARAM_REVERB_SIZE:
+            part.synth->setReverbSize(value);
+            break;
+          case PARAM_REVERB_TYPE:
+            part.synth->setReverbType((int)value);
+            break;
+          case PARAM_REVERB_MIX:
+            part.synth->setReverbMix(value);
+            break;
+          case PARAM_TREMELO_FREQUENCY:
+            part.synth->setLFOFrequency(0, value);
+            break;
+          case PARAM_TREMELO_DEPTH:
+            part.synth->setLFODepth(0, value);
+            break;
+          case PARAM_TREMELO_MIX:
+            part.synth->setTremeloMix(value);
+            break;
+          case PARAM_PAN_FREQUENCY:
+            part.synth->setLFOFrequency(1, value);
+            break;
+          case PARAM_PAN_DEPTH:
+            part.synth->setLFODepth(1, value);
+            break;
+          case PARAM_PAN_MIX:
+            part.synth->setPanMix(value);
+            break;
+          case PARAM_ATTACK:
+            part.A = value;
+            envelope = true;
+            break;
+          case PARAM_DECAY:
+            part.D = value;
+            envelope = true;
+            break;
+          case PARAM_SUSTAIN:
+            part.S = value;
+            envelope = true;
+            break;
+          case PARAM_RELEASE:
+            part.R = value;
+            envelope = true;
+            break;
+          case PARAM_ENVELOPE_CURVE:
+            part.synth->setADSRCurve(value < 0.5 ? ADSR::LINEAR : ADSR::EXPONENTIAL);
+            break;
+          case PARAM_VOLUME:
+            m_volume.store(value, std::memory_order_relaxed);
+            break;
+        }
+    }
+    if (envelope) setEnvelope(part);
+    part.changed = false;
+}
+
+//-----------------------------------------------------------------------------
+// name: setEnvelope()
+// desc: hand a part's envelope times to its synth
+//-----------------------------------------------------------------------------
+void MiEngine::setEnvelope(Part& part) {
+    part.synth->setADSR(part.A, part.D, part.S, part.R);
+}
+
+//-----------------------------------------------------------------------------
+// name: setLayout()
+// desc: set which knob layout control changes are mapped with, from any
+//       thread
+//-----------------------------------------------------------------------------
+void MiEngine::setLayout(int layoutMode) {
+    m_layoutMode = layoutMode;
+}
+
+//-----------------------------------------------------------------------------
+// name: setVolume()
+// desc: set the master volume from any thread, it reaches the parts at the
+//       start of the next block
+//-----------------------------------------------------------------------------
+void MiEngine::setVolume(StkFloat volume) {
+    m_volume.store(volume, std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------
+// name: setPipelineDepth()
+// desc: run the voice stage this many blocks ahead of the effects on a
+//       thread of its own, 0 renders everything in tick() again.  Call it
+//       while the engine isn't rendering.  The voice thread starts with the
+//       ring holding blocks of silence, so the latency is exact from the
+//       first block on.
+//-----------------------------------------------------------------------------
+void MiEngine::setPipelineDepth(int blocks) {
+    stopPipeline();
+    if (blocks < 0) blocks = 0;
+    if (blocks > PIPELINE_DEPTH_MAX) blocks = PIPELINE_DEPTH_MAX;
+    if (blocks == 0) return;
+
+    unsigned int blockSize = m_context.blockSize();
+    StkArena* previousArena = StkArena::current();
+    StkArena::setCurrent(m_arena);
+    m_slots.resize(blocks + 1);
+    for (unsigned int s = 0; s < m_slots.size(); s++) {
+        m_slots[s].mono.resize(m_parts.size());
+        m_slots[s].peak.assign(m_parts.size(), 0.0);
+        for (unsigned int i = 0; i < m_parts.size(); i++)
+            m_slots[s].mono[i].resize(blockSize, 1, 0.0);
+    }
+    for (unsigned int i = 0; i < m_parts.size(); i++)
+        if (m_parts[i].buffer.frames() < blockSize) m_parts[i].buffer.resize(blockSize, 2, 0.0);
+    m_pipelineOut.resize(blockSize, 2, 0.0);
+    StkArena::setCurrent(previousArena);
+
+    m_pipelineDepth = blocks;
+    m_consumed = 0;
+    m_produced = blocks;
+    m_pipelinePosition = blockSize;
+    m_pipelineQuit = false;
+    m_voiceThread = std::thread(&MiEngine::voiceLoop, this);
+}
+
+//-----------------------------------------------------------------------------
+// name: getControlMap()
+// desc: get the table of which knobs drive which parameters, change it while
+//       the engine isn't rendering
+//-----------------------------------------------------------------------------
+MiControlMap& MiEngine::getControlMap() {
+    return m_controlMap;
+}
+
+//-----------------------------------------------------------------------------
+// name: loadScale()
+// desc: retune every part to a Scala .scl scale, false if it can't be
+//       loaded.  Call it while the engine isn't rendering.
+//-----------------------------------------------------------------------------
+bool MiEngine::loadScale(const std::string& path) {
+    // every part has the same tuning, so if one can't load it none can
+    for (unsigned int i = 0; i < m_parts.size(); i++)
+        if (!m_parts[i].synth->loadScale(path)) return false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: loadKeyboardMap()
+// desc: map every part's scale onto the keys from a Scala .kbm keyboard map,
+//       false if it can't be loaded.  Call it while the engine isn't
+//       rendering.
+//-----------------------------------------------------------------------------
+bool MiEngine::loadKeyboardMap(const std::string& path) {
+    // every part has the same tuning, so if one can't load it none can
+    for (unsigned int i = 0; i < m_parts.size(); i++)
+        if (!m_parts[i].synth->loadKeyboardMap(path)) return false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: getLayout()
+// desc: get the knob layout mode
+//-----------------------------------------------------------------------------
+int MiEngine::getLayout() {
+    return m_layoutMode;
+}
+
+//-----------------------------------------------------------------------------
+// name: getLatency()
+// desc: get the frames of latency pipeline mode adds, 0 when it's off
+//-----------------------------------------------------------------------------
+unsigned int MiEngine::getLatency() {
+    return m_pipelineDepth * m_context.blockSize();
+}
+
+//-----------------------------------------------------------------------------
+// name: getPitchValue()
+// desc: get the last pitch wheel position of a part
+//-----------------------------------------------------------------------------
+int MiEngine::getPitchValue(int part) {
+    return m_parts.at(part).pitchValue;
+}
+
+//-----------------------------------------------------------------------------
+// name: getNumParts()
+// desc: get the number of parts, the MIDI channels the engine plays
+//-----------------------------------------------------------------------------
+int MiEngine::getNumParts() {
+    return (int) m_parts.size();
+}
+
+//-----------------------------------------------------------------------------
+// name: getSynth()
+// desc: get the synth of a part
+//-----------------------------------------------------------------------------
+MiSynth* MiEngine::getSynth(int part) {
+    return m_parts.at(part).synth;
+}
+
+//-----------------------------------------------------------------------------
+// name: getContext()
+// desc: get the context (sample rate and block size) the engine runs in
+//-----------------------------------------------------------------------------
+StkContext* MiEngine::getContext() {
+    return &m_context;
+}
@@ -0,0 +1,166 @@
+#ifndef MI_ENGINE_H
+#define MI_ENGINE_H
+
+#include "MiSynth.h"
+#include "MiRenderPool.h"
+#include "MiMidiInput.h"
+#include "MiControlMap.h"
+#include "MiSemaphore.h"
+#include <vector>
+
+using namespace stk;
+
+// MIDI status bytes the engine responds to
+#define NOTE_ON 144
+#define NOTE_OFF 128
+#define CONTROL_CHANGE 176
+#define PITCH_WHEEL 224
+
+// most parts an engine can have, one per MIDI channel
+#define MIDI_CHANNELS 16
+
+// most queued MIDI events played at the start of one block
+#define MIDI_BLOCK_EVENTS 256
+
+// most blocks the voice stage can run ahead of the effects in pipeline mode
+#define PIPELINE_DEPTH_MAX 4
+
+// how far the pitch wheel bends either way, in notes of the tuning
+#define PITCH_BEND_RANGE (2.0)
+
+#define DEFAULT_VOLUME (0.9)
+#define DEFAULT_PAN_MIX (0.1)
+
+//-----------------------------------------------------------------------------
+// name: class MiEngine
+// desc: one complete instrument: a MiSynth built in its own sample rate
+//       context and memory arena, the master volume and pan stage after it,
+//       and the MIDI state that maps notes and knobs onto it.  Engines share
+//       nothing, so a process can run several, each rendered on its own
+//       thread.  MIDI for an engine has to come in on the thread that
+//       renders it, or between its renders; an engine given a MiMidiQueue
+//       plays what is queued at the start of each block, in time order.
+//       Knobs are looked up in a MiControlMap and only set a pending value;
+//       each parameter a knob moved is applied once, at the start of the
+//       next block, however many messages the knob sent.  The master
+//       volume and each part's pan mix go to the part's synth with its
+//       effects settings, so the pan stage picks them up with the effects.
+//
+//       An engine with more than one part is multi-timbral: MIDI channel n
+//       plays part n, a MiSynth with its own voices, knob settings and
+//       effects.  The parts of a block are rendered in parallel on a
+//       MiRenderPool and summed.
+//
+//       In pipeline mode a voice thread runs every part's voice stage (voices
+//       and filter) a fixed number of blocks ahead, while the rendering
+//       thread runs the effects stage (echo, reverb, tremelo and pan) on
+//       blocks it has finished.  The stages hand blocks over through a ring
+//       of buffers indexed by two atomic counters, so neither waits on a
+//       lock: the voice thread sleeps on a MiSemaphore while the ring is
+//       full, and the rendering thread only posts it.  If the voice thread
+//       falls behind, the rendering thread spins until the block it needs
+//       is done.  Output is delayed by getLatency() frames.
+//-----------------------------------------------------------------------------
+class MiEngine {
+public:
+    // constructor
+    MiEngine( int numVoices = 8, StkFloat sampleRate = 44100.0,
+              unsigned int blockSize = RT_BUFFER_SIZE, bool lockMemory = false,
+              int numParts = 1 );
+    // destructor
+    virtual ~MiEngine();
+
+public:
+    StkFrames& tick(StkFrames& frames);
+    void processMidi(const std::vector<unsigned char>& message);
+    void processMidi(const unsigned char* message, unsigned int size);
+    void setMidiQueue(MiMidiQueue* queue);
+    void setLayout(int layoutMode);
+    MiControlMap& getControlMap();
+    bool loadScale(const std::string& path);
+    bool loadKeyboardMap(const std::string& path);
+    void setVolume(StkFloat volume);
+    void setPipelineDepth(int blocks);
+    int getLayout();
+    unsigned int getLatency();
+    int getPitchValue(int part = 0);
+    int getNumParts();
+    MiSynth* getSynth(int part = 0);
+    StkContext* getContext();
+
+private:
+    // one synth per MIDI channel, with the knob state that belongs to it
+    struct Part {
+        MiSynth* synth;
+        StkFrames buffer;
+        int pitchValue;
+        int nHarmonics;
+        StkFloat A;
+        StkFloat D;
+        StkFloat S;
+        StkFloat R;
+        // the latest value of each parameter a knob has moved since the
+        // last block
+        StkFloat controls[NUM_PARAMS];
+        bool pending[NUM_PARAMS];
+        bool changed;
+    };
+
+    // engines own their context and arena, so they can't be copied
+    MiEngine(const MiEngine&);
+    MiEngine& operator=(const MiEngine&);
+
+    // one block handed from the voice stage to the effects stage, a mono
+    // buffer and its peak for each part
+    struct PipelineSlot {
+        std::vector<StkFrames> mono;
+        std::vector<StkFloat> peak;
+    };
+
+    static void renderPartTask(void* engine, int index);
+    void renderPart(int index);
+    void panPart(Part& part, StkFrames& frames);
+    void mixParts(StkFloat* samples, unsigned int nFrames);
+    StkFrames& tickPipeline(StkFrames& frames);
+    void consumeBlock();
+    void voiceLoop();
+    void stopPipeline();
+    void drainMidi();
+    void controlChange(Part& part, int knobNumber, int intensity);
+    void applyControls();
+    void applyControls(Part& part);
+    void setEnvelope(Part& part);
+
+    StkContext m_context;
+    StkArena* m_arena;
+    std::vector<Part> m_parts;
+    MiRenderPool* m_pool;
+    unsigned int m_renderFrames;
+    PipelineSlot* m_renderSlot;
+    // the master volume as last set from any thread, and as last handed to
+    // the parts' effects stages
+    std::atomic<StkFloat> m_volume;
+    StkFloat m_partVolume;
+    std::atomic<int> m_layoutMode;
+    MiControlMap m_controlMap;
+
+    // queued MIDI, and the events of one block being put in order
+    MiMidiQueue* m_midiQueue;
+    MiMidiEvent m_midiEvents[MIDI_BLOCK_EVENTS];
+
+    // pipeline mode
+    int m_pipelineDepth;
+    std::vector<PipelineSlot> m_slots;
+    std::atomic<unsigned long> m_produced;
+    std::atomic<unsigned long> m_consumed;
+    StkFrames m_pipelineOut;
+    unsigned int m_pipelinePosition;
+    std::thread m_voiceThread;
+    // set while the voice thread is (about to be) asleep on m_voiceWake,
+    // whoever clears it posts
+    std::atomic<bool> m_voiceWaiting;
+    MiSemaphore m_voiceWake;
+    std::atomic<bool> m_pipelineQuit;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef MI_EXCHANGE_H
+#define MI_EXCHANGE_H
+
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// name: class MiExchange
+// desc: hands the latest copy of a T from one writing thread to one reading
+//       thread without either waiting (a triple buffer).  The writer fills
+//       back() and publishes it; the reader picks up whatever was published
+//       last with fetch() and reads it from front() until the next fetch.
+//       Neither side ever sees a half written T, and copies published in
+//       between fetches are skipped.
+//-----------------------------------------------------------------------------
+template <class T>
+class MiExchange {
+public:
+    // constructor
+    MiExchange();
+
+public:
+    T& back();
+    void publish();
+    bool fetch();
+    const T& front() const;
+
+private:
+    // the middle index carries a flag for a copy the reader hasn't fetched
+    enum { SLOT = 3, FRESH = 4 };
+
+    // exchanges own their copies in place, so they can't be copied
+    MiExchange(const MiExchange&);
+    MiExchange& operator=(const MiExchange&);
+
+    T m_slots[3];
+    int m_back;
+    int m_front;
+    std::atomic<int> m_middle;
+};
+
+//-----------------------------------------------------------------------------
+// name: MiExchange()
+// desc: constructor
+//-----------------------------------------------------------------------------
+template <class T>
+MiExchange<T>::MiExchange() : m_back(0), m_front(1), m_middle(2) { }
+
+//-----------------------------------------------------------------------------
+// name: back()
+// desc: the copy the writer fills in before publishing it
+//-----------------------------------------------------------------------------
+template <class T>
+inline T& MiExchange<T>::back() {
+    return m_slots[m_back];
+}
+
+//-----------------------------------------------------------------------------
+// name: publish()
+// desc: hand back() over to the reader, back() is then a stale copy
+//-----------------------------------------------------------------------------
+template <class T>
+inline void MiExchange<T>::publish() {
+    m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & SLOT;
+}
+
+//-----------------------------------------------------------------------------
+// name: fetch()
+// desc: move the reader on to the latest published copy, returns false if
+//       nothing has been published since the last fetch
+//-----------------------------------------------------------------------------
+template <class T>
+inline bool MiExchange<T>::fetch() {
+    if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & SLOT;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: front()
+// desc: the copy the reader fetched last
+//-----------------------------------------------------------------------------
+template <class T>
+inline const T& MiExchange<T>::front() const {
+    return m_slots[m_front];
+}
+
+#endif
@@ -0,0 +1,310 @@
+// MiMidiInput.cpp
+#include "MiMidiInput.h"
+#include <iostream>
+
+  //-------------//
+ // MiMidiQueue //
+//-------------//
+
+//-----------------------------------------------------------------------------
+// name: MiMidiQueue()
+// desc: constructor
+//-----------------------------------------------------------------------------
+MiMidiQueue::MiMidiQueue() : m_write(0), m_read(0) { }
+
+//-----------------------------------------------------------------------------
+// name: push()
+// desc: add an event, from any thread.  Returns false (and drops the event)
+//       when the queue is full.
+//-----------------------------------------------------------------------------
+bool MiMidiQueue::push(const MiMidiEvent& event) {
+    std::lock_guard<std::mutex> lock(m_pushMutex);
+    unsigned long write = m_write.load(std::memory_order_relaxed);
+    if (write - m_read.load(std::memory_order_acquire) >= MIDI_QUEUE_SIZE) return false;
+
+    m_events[write % MIDI_QUEUE_SIZE] = event;
+    m_write.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: pop()
+// desc: take the oldest event, from the one consuming thread.  Returns false
+//       when the queue is empty.
+//-----------------------------------------------------------------------------
+bool MiMidiQueue::pop(MiMidiEvent& event) {
+    unsigned long read = m_read.load(std::memory_order_relaxed);
+    if (read == m_write.load(std::memory_order_acquire)) return false;
+
+    event = m_events[read % MIDI_QUEUE_SIZE];
+    m_read.store(read + 1, std::memory_order_release);
+    return true;
+}
+
+  //-------------//
+ // MiMidiInput //
+//-------------//
+
+//-----------------------------------------------------------------------------
+// name: MiMidiInput()
+// desc: constructor, throws RtMidiError if there is no MIDI system
+//-----------------------------------------------------------------------------
+MiMidiInput::MiMidiInput()
+    : m_watchQuit(false), m_watcher(NULL), m_watcherData(NULL),
+      m_watchInterval(MIDI_SCAN_INTERVAL) {
+    // a port-less input to list the ports with
+    m_scanner = new RtMidiIn();
+    m_start = std::chrono::steady_clock::now();
+}
+
+//-----------------------------------------------------------------------------
+// name: ~MiMidiInput()
+// desc: destructor
+//-----------------------------------------------------------------------------
+MiMidiInput::~MiMidiInput() {
+    stopWatching();
+    closePorts();
+    delete m_scanner;
+}
+
+//-----------------------------------------------------------------------------
+// name: getPortCount()
+// desc: get the number of MIDI input ports in the system
+//-----------------------------------------------------------------------------
+unsigned int MiMidiInput::getPortCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_scanner->getPortCount();
+}
+
+//-----------------------------------------------------------------------------
+// name: getPortName()
+// desc: get the name of a MIDI input port, throws RtMidiError on failure
+//-----------------------------------------------------------------------------
+std::string MiMidiInput::getPortName(unsigned int port) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_scanner->getPortName(port);
+}
+
+//-----------------------------------------------------------------------------
+// name: findPort()
+// desc: get the first port whose name contains name, or -1
+//-----------------------------------------------------------------------------
+int MiMidiInput::findPort(const std::string& name) {
+    std::vector<std::string> names = listPorts();
+    for (unsigned int i = 0; i < names.size(); i++) {
+        if (names[i].find(name) != std::string::npos) return (int) i;
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+// name: openPort()
+// desc: open the first port whose name contains name and start queueing its
+//       messages, unless one is open already.  Sysex, timing clock and
+//       active sensing are ignored: the engine plays none of them, and a
+//       clock sends 24 a beat.  Returns false if there is no such port or
+//       it can't be opened.
+//-----------------------------------------------------------------------------
+bool MiMidiInput::openPort(const std::string& name) {
+    if (isOpen(name)) return true;
+
+    int port = findPort(name);
+    if (port < 0) return false;
+
+    Port* input = new Port;
+    input->input = this;
+    input->index = port;
+    input->midiIn = NULL;
+    try {
+        input->name = getPortName(port);
+        input->midiIn = new RtMidiIn();
+        input->midiIn->setCallback(&midiCallback, input);
+        input->midiIn->ignoreTypes(true, true, true);
+        input->midiIn->openPort(port);
+    }
+    catch (RtMidiError &error) {
+        error.printMessage();
+        delete input->midiIn;
+        delete input;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ports.push_back(input);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: isOpen()
+// desc: is a port whose name contains name open
+//-----------------------------------------------------------------------------
+bool MiMidiInput::isOpen(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int i = 0; i < m_ports.size(); i++) {
+        if (m_ports[i]->name.find(name) != std::string::npos) return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// name: closePort()
+// desc: close every open port whose name contains name
+//-----------------------------------------------------------------------------
+void MiMidiInput::closePort(const std::string& name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int i = 0; i < m_ports.size(); ) {
+        if (m_ports[i]->name.find(name) == std::string::npos) {
+            i++;
+            continue;
+        }
+        // deleting the RtMidiIn stops its callback
+        delete m_ports[i]->midiIn;
+        delete m_ports[i];
+        m_ports.erase(m_ports.begin() + i);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: closePorts()
+// desc: close every open port
+//-----------------------------------------------------------------------------
+void MiMidiInput::closePorts() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int i = 0; i < m_ports.size(); i++) {
+        delete m_ports[i]->midiIn;
+        delete m_ports[i];
+    }
+    m_ports.clear();
+}
+
+//-----------------------------------------------------------------------------
+// name: getNumOpen()
+// desc: get the number of open ports
+//-----------------------------------------------------------------------------
+int MiMidiInput::getNumOpen() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int) m_ports.size();
+}
+
+//-----------------------------------------------------------------------------
+// name: getQueue()
+// desc: get the queue every open port feeds
+//-----------------------------------------------------------------------------
+MiMidiQueue* MiMidiInput::getQueue() {
+    return &m_queue;
+}
+
+//-----------------------------------------------------------------------------
+// name: startWatching()
+// desc: start a thread that rescans the ports every interval milliseconds
+//       and, whenever the list has changed, closes ports that have gone and
+//       calls watcher(this, data) from that thread.  A device replugged
+//       within one interval isn't noticed (see the class comment).
+//-----------------------------------------------------------------------------
+void MiMidiInput::startWatching(Watcher watcher, void* data, int interval) {
+    stopWatching();
+
+    m_watcher = watcher;
+    m_watcherData = data;
+    m_watchInterval = interval;
+    m_watchQuit = false;
+    m_watchThread = std::thread(&MiMidiInput::watchLoop, this);
+}
+
+//-----------------------------------------------------------------------------
+// name: stopWatching()
+// desc: stop the watching thread, if there is one
+//-----------------------------------------------------------------------------
+void MiMidiInput::stopWatching() {
+    if (!m_watchThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        m_watchQuit = true;
+    }
+    m_watchWake.notify_all();
+    m_watchThread.join();
+}
+
+//-----------------------------------------------------------------------------
+// name: listPorts()
+// desc: get the names of every MIDI input port in the system
+//-----------------------------------------------------------------------------
+std::vector<std::string> MiMidiInput::listPorts() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> names;
+    try {
+        unsigned int nPorts = m_scanner->getPortCount();
+        for (unsigned int i = 0; i < nPorts; i++)
+            names.push_back(m_scanner->getPortName(i));
+    }
+    catch (RtMidiError &error) {
+        // a port went away while listing, the next scan will catch up
+        error.printMessage();
+    }
+    return names;
+}
+
+//-----------------------------------------------------------------------------
+// name: closeMissing()
+// desc: close open ports that aren't among names any more
+//-----------------------------------------------------------------------------
+void MiMidiInput::closeMissing(const std::vector<std::string>& names) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned int i = 0; i < m_ports.size(); ) {
+        bool present = false;
+        for (unsigned int j = 0; j < names.size(); j++)
+            present = present || names[j] == m_ports[i]->name;
+        if (present) {
+            i++;
+            continue;
+        }
+        std::cout << "MIDI input disconnected: " << m_ports[i]->name << '\n';
+        delete m_ports[i]->midiIn;
+        delete m_ports[i];
+        m_ports.erase(m_ports.begin() + i);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: watchLoop()
+// desc: the watching thread, compares each scan's port names with the
+//       last until stopped
+//-----------------------------------------------------------------------------
+void MiMidiInput::watchLoop() {
+    std::vector<std::string> last = listPorts();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_watchMutex);
+            m_watchWake.wait_for(lock, std::chrono::milliseconds(m_watchInterval));
+            if (m_watchQuit) return;
+        }
+
+        std::vector<std::string> names = listPorts();
+        if (names == last) continue;
+        last = names;
+
+        closeMissing(names);
+        if (m_watcher != NULL) m_watcher(this, m_watcherData);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: midiCallback()
+// desc: RtMidi callback, runs on the port's own thread.  Stamps the message
+//       with the shared clock and queues it.  Messages longer than three
+//       bytes (sysex) are dropped.
+//-----------------------------------------------------------------------------
+void MiMidiInput::midiCallback(double /*deltaTime*/, std::vector<unsigned char>* message, void* userData) {
+    Port* port = (Port*) userData;
+    if (message->size() == 0 || message->size() > 3) return;
+
+    MiMidiEvent event;
+    event.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - port->input->m_start).count();
+    event.port = port->index;
+    event.size = (unsigned char) message->size();
+    for (unsigned int i = 0; i < 3; i++)
+        event.data[i] = i < message->size() ? (*message)[i] : 0;
+
+    if (!port->input->m_queue.push(event))
+        std::cerr << "MiMidiInput: queue full, dropping a message\n";
+}
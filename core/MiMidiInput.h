@@ -0,0 +1,131 @@
+#ifndef MI_MIDI_INPUT_H
+#define MI_MIDI_INPUT_H
+
+#include "RtMidi.h"
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+
+// events the queue holds before new ones are dropped
+#define MIDI_QUEUE_SIZE 1024
+
+// milliseconds between rescans of the port list when watching for devices
+#define MIDI_SCAN_INTERVAL 1000
+
+//-----------------------------------------------------------------------------
+// name: struct MiMidiEvent
+// desc: one short MIDI message, the time (seconds since the input was
+//       created) it arrived, and the index of the port it came in on
+//-----------------------------------------------------------------------------
+struct MiMidiEvent {
+    double time;
+    int port;
+    unsigned char size;
+    unsigned char data[3];
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiMidiQueue
+// desc: fixed size queue carrying MIDI events from any number of input
+//       threads to one rendering thread.  Pushing takes a lock among the
+//       inputs; popping never blocks, so the audio thread can drain it.
+//-----------------------------------------------------------------------------
+class MiMidiQueue {
+public:
+    // constructor
+    MiMidiQueue();
+
+public:
+    bool push(const MiMidiEvent& event);
+    bool pop(MiMidiEvent& event);
+
+private:
+    MiMidiEvent m_events[MIDI_QUEUE_SIZE];
+    std::atomic<unsigned long> m_write;
+    std::atomic<unsigned long> m_read;
+    std::mutex m_pushMutex;
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiMidiInput
+// desc: every open MIDI input port feeding one MiMidiQueue.  Each port
+//       delivers its messages from its own RtMidi callback as soon as they
+//       arrive, so no port waits on another and nothing is polled.  Events
+//       are stamped on arrival with one clock for all ports, so the
+//       consumer can put events from different devices back in order.
+//
+//       Once watching, a background thread rescans the port names, closes
+//       ports whose device has gone and tells the owner whenever the list
+//       changes, so it can open devices as they are plugged in.  Opening and
+//       closing ports only ever happens off the audio and MIDI threads.
+//
+//       Names are all the watcher has to go on: RtMidi doesn't say when an
+//       open port's device goes away, and ALSA usually gives a replugged
+//       device its old client number, so its port name comes back the
+//       same.  A device pulled out and plugged back in between two scans
+//       therefore looks unchanged, and its port stays open but dead until
+//       it is closed and opened again (or unplugged for longer than a
+//       scan interval).
+//-----------------------------------------------------------------------------
+class MiMidiInput {
+public:
+    typedef void (*Watcher)(MiMidiInput* input, void* data);
+
+    // constructor
+    MiMidiInput();
+    // destructor
+    ~MiMidiInput();
+
+public:
+    unsigned int getPortCount();
+    std::string getPortName(unsigned int port);
+    int findPort(const std::string& name);
+    bool openPort(const std::string& name);
+    bool isOpen(const std::string& name);
+    void closePort(const std::string& name);
+    void closePorts();
+    int getNumOpen();
+    MiMidiQueue* getQueue();
+    void startWatching(Watcher watcher, void* data, int interval = MIDI_SCAN_INTERVAL);
+    void stopWatching();
+
+private:
+    // an open port, and what its callback needs
+    struct Port {
+        MiMidiInput* input;
+        int index;
+        std::string name;
+        RtMidiIn* midiIn;
+    };
+
+    // inputs own their ports, so they can't be copied
+    MiMidiInput(const MiMidiInput&);
+    MiMidiInput& operator=(const MiMidiInput&);
+
+    static void midiCallback(double deltaTime, std::vector<unsigned char>* message, void* userData);
+    std::vector<std::string> listPorts();
+    void closeMissing(const std::vector<std::string>& names);
+    void watchLoop();
+
+    // the scanner and the open ports, guarded so the watcher can use them
+    std::mutex m_mutex;
+    RtMidiIn* m_scanner;
+    std::vector<Port*> m_ports;
+    MiMidiQueue m_queue;
+    std::chrono::steady_clock::time_point m_start;
+
+    // watching for devices
+    std::thread m_watchThread;
+    std::mutex m_watchMutex;
+    std::condition_variable m_watchWake;
+    bool m_watchQuit;
+    Watcher m_watcher;
+    void* m_watcherData;
+    int m_watchInterval;
+};
+
+#endif
@@ -0,0 +1,115 @@
+// MiRenderPool.cpp
+#include "MiRenderPool.h"
+
+//-----------------------------------------------------------------------------
+// name: MiRenderPool()
+// desc: constructor, starts numThreads workers, which sleep until there is a
+//       batch to run
+//-----------------------------------------------------------------------------
+MiRenderPool::MiRenderPool(int numThreads)
+    : m_quit(false), m_sequence(0), m_task(0), m_data(0), m_numTasks(0),
+      m_claim(0), m_remaining(0) {
+    for (int i = 0; i < numThreads; i++)
+        m_threads.push_back(std::thread(&MiRenderPool::workerLoop, this));
+}
+
+//-----------------------------------------------------------------------------
+// name: ~MiRenderPool()
+// desc: destructor, stops and joins the workers
+//-----------------------------------------------------------------------------
+MiRenderPool::~MiRenderPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (unsigned int i = 0; i < m_threads.size(); i++)
+        m_threads[i].join();
+}
+
+//-----------------------------------------------------------------------------
+// name: run()
+// desc: call task(data, i) for every i below numTasks, spread across the
+//       workers and the calling thread, and wait for all of them
+//-----------------------------------------------------------------------------
+void MiRenderPool::run(int numTasks, Task task, void* data) {
+    if (numTasks <= 0) return;
+
+    // publish the batch between an odd and an even sequence number, the
+    // claim counter last so workers still on the old batch stop claiming
+    unsigned long sequence = m_sequence.load(std::memory_order_relaxed) + 1;
+    m_sequence.store(sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_task.store(task, std::memory_order_relaxed);
+    m_data.store(data, std::memory_order_relaxed);
+    m_numTasks.store(numTasks, std::memory_order_relaxed);
+    m_remaining.store(numTasks, std::memory_order_relaxed);
+    unsigned long generation = (sequence + 1) / 2;
+    m_claim.store((unsigned long long)(generation & 0xffffffffUL) << 32, std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_release);
+
+    // without the lock a worker about to sleep can miss this, it then
+    // sits the batch out and the tasks it would have run are run here
+    if (m_threads.size() > 0 && numTasks > 1)
+        m_wake.notify_all();
+
+    runTasks(generation, task, data, numTasks);
+
+    // the last few tasks finish on the workers, they take well under a block
+    while (m_remaining.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+}
+
+//-----------------------------------------------------------------------------
+// name: getNumThreads()
+// desc: get the number of worker threads (not counting the caller of run())
+//-----------------------------------------------------------------------------
+int MiRenderPool::getNumThreads() {
+    return (int) m_threads.size();
+}
+
+//-----------------------------------------------------------------------------
+// name: workerLoop()
+// desc: a worker thread, runs tasks from each new batch until told to quit
+//-----------------------------------------------------------------------------
+void MiRenderPool::workerLoop() {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_quit && m_sequence.load(std::memory_order_acquire) == seen)
+                m_wake.wait(lock);
+            if (m_quit) return;
+        }
+
+        // read the batch, and start over if run() was writing it meanwhile
+        unsigned long sequence = m_sequence.load(std::memory_order_acquire);
+        if (sequence & 1) continue;
+        Task task = m_task.load(std::memory_order_relaxed);
+        void* data = m_data.load(std::memory_order_relaxed);
+        int numTasks = m_numTasks.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+        seen = sequence;
+        runTasks(sequence / 2, task, data, numTasks);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: runTasks()
+// desc: claim and run tasks from batch generation until there are none left
+//-----------------------------------------------------------------------------
+void MiRenderPool::runTasks(unsigned long generation, Task task, void* data, int numTasks) {
+    unsigned long long first = (unsigned long long)(generation & 0xffffffffUL) << 32;
+    unsigned long long claim = m_claim.load();
+    while (true) {
+        // stop once the batch is used up, or has been replaced by a new one
+        if ((claim & ~0xffffffffULL) != first || (int)(claim - first) >= numTasks) return;
+        if (!m_claim.compare_exchange_weak(claim, claim + 1)) continue;
+
+        task(data, (int)(claim - first));
+        m_remaining.fetch_sub(1, std::memory_order_release);
+        claim = m_claim.load();
+    }
+}
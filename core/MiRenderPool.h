@@ -0,0 +1,70 @@
+#ifndef MI_RENDER_POOL_H
+#define MI_RENDER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// name: class MiRenderPool
+// desc: worker threads that run a batch of independent tasks (one per part
+//       of a block) in parallel.  The thread calling run() works through the
+//       batch too and returns once every task has finished, so a pool of n
+//       threads keeps n + 1 cores busy.  Tasks are handed out one at a time,
+//       so a part that happens to be busy doesn't hold up the others.
+//
+//       run() is called from the audio thread, so it publishes each batch
+//       with atomics and wakes the workers without taking their lock; it
+//       never waits for a lock a worker holds.  A worker that misses the
+//       wakeup just sits the batch out, and the caller runs every task
+//       the workers haven't claimed.  The one wait left is at the end of
+//       run(): it spins until the tasks workers have already claimed are
+//       done.  The workers run at normal priority, so a worker descheduled
+//       partway through a task holds the caller up until it gets the CPU
+//       back and finishes.
+//-----------------------------------------------------------------------------
+class MiRenderPool {
+public:
+    typedef void (*Task)(void* data, int index);
+
+    // constructor
+    MiRenderPool(int numThreads);
+    // destructor
+    ~MiRenderPool();
+
+public:
+    void run(int numTasks, Task task, void* data);
+    int getNumThreads();
+
+private:
+    // pools own their threads, so they can't be copied
+    MiRenderPool(const MiRenderPool&);
+    MiRenderPool& operator=(const MiRenderPool&);
+
+    void workerLoop();
+    void runTasks(unsigned long generation, Task task, void* data, int numTasks);
+
+    std::vector<std::thread> m_threads;
+    // where the workers sleep between batches, only they and the
+    // destructor take the lock
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit;
+
+    // the batch being run.  run() makes m_sequence odd while it writes a
+    // batch and even (twice the batch generation) once it's done, so a
+    // worker can tell it read one batch whole.
+    std::atomic<unsigned long> m_sequence;
+    std::atomic<Task> m_task;
+    std::atomic<void*> m_data;
+    std::atomic<int> m_numTasks;
+    // next task to claim, tagged with the batch generation in the high
+    // bits so a worker still finishing an old batch can't claim from a
+    // new one
+    std::atomic<unsigned long long> m_claim;
+    std::atomic<int> m_remaining;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef MI_SEMAPHORE_H
+#define MI_SEMAPHORE_H
+
+#if defined(__APPLE__)
+  #include <dispatch/dispatch.h>
+#elif defined(_WIN32)
+  #include <windows.h>
+#else
+  #include <semaphore.h>
+  #include <errno.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// name: class MiSemaphore
+// desc: a counting semaphore for waking a sleeping thread from the audio
+//       thread.  post() never blocks or takes a lock a sleeping thread could
+//       be holding, so it is safe in the audio callback; wait() sleeps until
+//       there is a post to take.
+//-----------------------------------------------------------------------------
+class MiSemaphore {
+public:
+    // constructor
+    MiSemaphore();
+    // destructor
+    ~MiSemaphore();
+
+public:
+    void post();
+    void wait();
+
+private:
+    // semaphores own an OS object, so they can't be copied
+    MiSemaphore(const MiSemaphore&);
+    MiSemaphore& operator=(const MiSemaphore&);
+
+#if defined(__APPLE__)
+    dispatch_semaphore_t m_semaphore;
+#elif defined(_WIN32)
+    HANDLE m_semaphore;
+#else
+    sem_t m_semaphore;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+// name: MiSemaphore()
+// desc: constructor, starts with nothing posted
+//-----------------------------------------------------------------------------
+inline MiSemaphore::MiSemaphore() {
+#if defined(__APPLE__)
+    m_semaphore = dispatch_semaphore_create(0);
+#elif defined(_WIN32)
+    m_semaphore = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+#else
+    sem_init(&m_semaphore, 0, 0);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// name: ~MiSemaphore()
+// desc: destructor
+//-----------------------------------------------------------------------------
+inline MiSemaphore::~MiSemaphore() {
+#if defined(__APPLE__)
+    dispatch_release(m_semaphore);
+#elif defined(_WIN32)
+    CloseHandle(m_semaphore);
+#else
+    sem_destroy(&m_semaphore);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// name: post()
+// desc: add a post, waking a thread in wait() if there is one
+//-----------------------------------------------------------------------------
+inline void MiSemaphore::post() {
+#if defined(__APPLE__)
+    dispatch_semaphore_signal(m_semaphore);
+#elif defined(_WIN32)
+    ReleaseSemaphore(m_semaphore, 1, NULL);
+#else
+    sem_post(&m_semaphore);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// name: wait()
+// desc: take a post, sleeping until there is one
+//-----------------------------------------------------------------------------
+inline void MiSemaphore::wait() {
+#if defined(__APPLE__)
+    dispatch_semaphore_wait(m_semaphore, DISPATCH_TIME_FOREVER);
+#elif defined(_WIN32)
+    WaitForSingleObject(m_semaphore, INFINITE);
+#else
+    // a signal can interrupt the wait, which isn't a post
+    while (sem_wait(&m_semaphore) != 0 && errno == EINTR) { }
+#endif
+}
+
+#endif
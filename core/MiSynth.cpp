@@ -3,19 +3,278 @@
 
 using namespace stk;
 
+//-----------------------------------------------------------------------------
+// name: createInArena()
+// desc: build an engine object in the current arena (see StkArena), next to
+//       the objects built just before it, or on the heap when there is none
+//-----------------------------------------------------------------------------
+template <class T>
+static T* createInArena() {
+    StkArena* arena = StkArena::current();
+    return arena ? arena->create<T>() : new T();
+}
+
+//-----------------------------------------------------------------------------
+// name: destroyOutsideArena()
+// desc: delete an object from createInArena() unless it lives in an arena,
+//       which destroys it itself
+//-----------------------------------------------------------------------------
+template <class T>
+static void destroyOutsideArena(T* object) {
+    if (!StkArena::isArenaMemory(object)) delete object;
+}
+
+  //---------//
+ // MiPatch //
+//---------//
+
+//-----------------------------------------------------------------------------
+// name: MiPatch()
+// desc: constructor, the settings a new voice starts out with, at the
+//       sample rate of the current context
+//-----------------------------------------------------------------------------
+MiPatch::MiPatch() {
+    m_context = StkContext::current();
+    // voices start at version 0, so they all catch up on first use
+    m_version = 1;
+    m_envelopeVersion = 1;
+    m_tuningVersion = 1;
+
+    m_adsrCurve = ADSR::LINEAR;
+    m_A = 0.01;
+    m_D = 0.2;
+    m_S = 0.5;
+    m_R = 0.5;
+    setADSR(m_A, m_D, m_S, m_R);
+
+    for (int i = 0; i < MAX_OSCILLATORS; i++) {
+        m_waveShape[i] = SAW;
+        m_oscVolume[i] = 0.5;
+        m_oscTuning[i] = 1.0;
+    }
+    m_nHarmonics = 0;
+    m_tuning = NULL;
+    m_pitchBend = 0.0;
+}
+
+//-----------------------------------------------------------------------------
+// name: setADSR()
+// desc: set attack, decay, sustain and release, and work out the envelope
+//       rates once for every voice (as ADSR::setAllTimes() would)
+//-----------------------------------------------------------------------------
+void MiPatch::setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R) {
+    if (A <= 0.0 || D <= 0.0 || S < 0.0 || R <= 0.0) {
+        Stk::handleError("MiPatch::setADSR: times must be positive and the sustain level non-negative!", StkError::WARNING);
+        return;
+    }
+
+    StkFloat sampleRate = m_context->sampleRate();
+    m_A = A;
+    m_D = D;
+    m_S = S;
+    m_R = R;
+    m_attackRate = 1.0 / (A * sampleRate);
+    m_decayRate = (1.0 - S) / (D * sampleRate);
+    m_releaseRate = S / (R * sampleRate);
+    m_envelopeVersion = ++m_version;
+}
+
+//-----------------------------------------------------------------------------
+// name: setADSRCurve()
+// desc: set the envelope curve (ADSR::LINEAR or ADSR::EXPONENTIAL)
+//-----------------------------------------------------------------------------
+void MiPatch::setADSRCurve(int curve) {
+    if (curve != ADSR::LINEAR && curve != ADSR::EXPONENTIAL) {
+        Stk::handleError("MiPatch::setADSRCurve: unknown curve type!", StkError::WARNING);
+        return;
+    }
+
+    m_adsrCurve = curve;
+    m_envelopeVersion = ++m_version;
+}
+
+//-----------------------------------------------------------------------------
+// name: setWaveShape()
+// desc: set the wave shape of an oscillator
+//-----------------------------------------------------------------------------
+void MiPatch::setWaveShape(int oscNum, int waveShape) {
+    if (oscNum < 0 || oscNum >= MAX_OSCILLATORS) return;
+    m_waveShape[oscNum] = waveShape;
+    m_version++;
+}
+
+//-----------------------------------------------------------------------------
+// name: setOscVolume()
+// desc: set the volume of an oscillator
+//-----------------------------------------------------------------------------
+void MiPatch::setOscVolume(int oscNum, StkFloat volume) {
+    if (oscNum < 0 || oscNum >= MAX_OSCILLATORS) return;
+    m_oscVolume[oscNum] = volume;
+    m_version++;
+}
+
+//-----------------------------------------------------------------------------
+// name: setOscTuning()
+// desc: set the tuning (frequency ratio to the note) of an oscillator
+//-----------------------------------------------------------------------------
+void MiPatch::setOscTuning(int oscNum, double oscTuning) {
+    if (oscNum < 0 || oscNum >= MAX_OSCILLATORS) return;
+    m_oscTuning[oscNum] = oscTuning;
+    m_version++;
+}
+
+//-----------------------------------------------------------------------------
+// name: setNHarmonics()
+// desc: set the number of harmonics generated by BLIT algorithms (saw & square)
+//-----------------------------------------------------------------------------
+void MiPatch::setNHarmonics(int nHarmonics) {
+    m_nHarmonics = nHarmonics;
+    m_version++;
+}
+
+//-----------------------------------------------------------------------------
+// name: setTuning()
+// desc: set the note tables voices look their frequencies up in, also to
+//       have voices retune after the tables were reloaded.  NULL is equal
+//       temperament, worked out on every note.
+//-----------------------------------------------------------------------------
+void MiPatch::setTuning(const MiTuning* tuning) {
+    m_tuning = tuning;
+    m_tuningVersion = ++m_version;
+}
+
+//-----------------------------------------------------------------------------
+// name: setPitchBend()
+// desc: set the pitch bend, in notes of the tuning up (or down if negative)
+//-----------------------------------------------------------------------------
+void MiPatch::setPitchBend(double pitchBend) {
+    if (pitchBend == m_pitchBend) return;
+    m_pitchBend = pitchBend;
+    m_tuningVersion = ++m_version;
+}
+
+//-----------------------------------------------------------------------------
+// name: applyEnvelope()
+// desc: hand the envelope rates to a voice's ADSR, nothing is recomputed
+//-----------------------------------------------------------------------------
+void MiPatch::applyEnvelope(ADSR& adsr) const {
+    adsr.setAllRates(m_attackRate, m_decayRate, m_S, m_releaseRate, m_R);
+}
+
+//-----------------------------------------------------------------------------
+// name: getVersion()
+// desc: get the version, bumped by every change
+//-----------------------------------------------------------------------------
+unsigned long MiPatch::getVersion() const {
+    return m_version;
+}
+
+//-----------------------------------------------------------------------------
+// name: getEnvelopeVersion()
+// desc: get the version the envelope or its curve last changed at
+//-----------------------------------------------------------------------------
+unsigned long MiPatch::getEnvelopeVersion() const {
+    return m_envelopeVersion;
+}
+
+//-----------------------------------------------------------------------------
+// name: getTuningVersion()
+// desc: get the version the note tables or the pitch bend last changed at
+//-----------------------------------------------------------------------------
+unsigned long MiPatch::getTuningVersion() const {
+    return m_tuningVersion;
+}
+
+//-----------------------------------------------------------------------------
+// name: getADSRCurve()
+// desc: get the envelope curve
+//-----------------------------------------------------------------------------
+int MiPatch::getADSRCurve() const {
+    return m_adsrCurve;
+}
+
+//-----------------------------------------------------------------------------
+// name: getWaveShape()
+// desc: get the wave shape of an oscillator
+//-----------------------------------------------------------------------------
+int MiPatch::getWaveShape(int oscNum) const {
+    return m_waveShape[oscNum];
+}
+
+//-----------------------------------------------------------------------------
+// name: getOscVolume()
+// desc: get the volume of an oscillator
+//-----------------------------------------------------------------------------
+StkFloat MiPatch::getOscVolume(int oscNum) const {
+    return m_oscVolume[oscNum];
+}
+
+//-----------------------------------------------------------------------------
+// name: getOscTuning()
+// desc: get the tuning of an oscillator
+//-----------------------------------------------------------------------------
+double MiPatch::getOscTuning(int oscNum) const {
+    return m_oscTuning[oscNum];
+}
+
+//-----------------------------------------------------------------------------
+// name: getNHarmonics()
+// desc: get the number of BLIT harmonics
+//-----------------------------------------------------------------------------
+int MiPatch::getNHarmonics() const {
+    return m_nHarmonics;
+}
+
+//-----------------------------------------------------------------------------
+// name: getIncrement()
+// desc: get the phase increment of a note, bent by the pitch bend
+//-----------------------------------------------------------------------------
+double MiPatch::getIncrement(int note) const {
+    if (m_tuning == NULL) return XFun::midi2freq(note + m_pitchBend) / m_context->sampleRate();
+    return m_tuning->getIncrement(note + m_pitchBend);
+}
+
+  //-------//
+ // MiOsc //
+//-------//
+
+StkFloat MiOsc::s_sineTable[OSC_SINE_TABLE_SIZE + 1];
+
 //-----------------------------------------------------------------------------
 // name: MiOsc()
 // desc: constructor
 //-----------------------------------------------------------------------------
 MiOsc::MiOsc() {
+    // the first oscillator fills the shared sine table, once even when
+    // oscillators are built on several threads
+    static const bool sineTableFilled = fillSineTable();
+    (void) sineTableFilled;
+
+    m_context = StkContext::current();
     m_waveShape = SAW;
+    m_nHarmonics = 0;
     m_oscVolume = 0.5;
     m_tune = 1.0;
-    m_freq = 200.0;
 
-    m_sine.setFrequency(m_freq);
-    m_blitSaw.setFrequency(m_freq);
-    m_blitSquare.setFrequency(m_freq);
+    m_phase = 0.0;
+    m_sawState = 0.0;
+    m_squareBlit = 0.0;
+    m_squareDcb = 0.0;
+    m_squareOut = 0.0;
+
+    setFrequency(200.0);
+}
+
+//-----------------------------------------------------------------------------
+// name: fillSineTable()
+// desc: one cycle of sine plus a guard entry, the table is the same at
+//       every sample rate
+//-----------------------------------------------------------------------------
+bool MiOsc::fillSineTable() {
+    StkFloat step = TWO_PI / OSC_SINE_TABLE_SIZE;
+    for (unsigned int i = 0; i <= OSC_SINE_TABLE_SIZE; i++)
+        s_sineTable[i] = sin(i * step);
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -26,10 +285,27 @@ MiOsc::~MiOsc() { }
 
 //-----------------------------------------------------------------------------
 // name: SetWaveShape()
-// desc: set the wave shape for the oscilator
+// desc: set the wave shape for the oscilator.  The phase carries over, and
+//       the integrator of the new shape is set to where its wave sits at
+//       that phase, so switching doesn't click
 //-----------------------------------------------------------------------------
 void MiOsc::setWaveShape(int waveShape) {
+    if (waveShape == m_waveShape) return;
     m_waveShape = waveShape;
+
+    // the BLIT pulse at phase 0 is still to come, so a wave seeded there
+    // starts from the end of its cycle
+    if (waveShape == SAW) {
+        // the saw falls from +0.5 to -0.5 over a cycle
+        m_sawState = m_phase > 0.0 ? 0.5 - m_phase : -0.5;
+    }
+    else if (waveShape == SQUARE) {
+        // the summed BLIT is high for the first half cycle, the DC
+        // blocker centres it on zero
+        m_squareBlit = (m_phase > 0.0 && m_phase <= 0.5) ? 1.0 : 0.0;
+        m_squareDcb = m_squareBlit;
+        m_squareOut = m_squareBlit - 0.5;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -46,12 +322,22 @@ void MiOsc::setVolume(StkFloat volume) {
 // desc: Set frequency for the oscilator
 //-----------------------------------------------------------------------------
 void MiOsc::setFrequency(double freq) {
-    m_freq = freq;
-    freq *= m_tune;
+    setIncrement(freq / m_context->sampleRate());
+}
+
+//-----------------------------------------------------------------------------
+// name: setIncrement()
+// desc: Set the phase increment (cycles per sample, as in a MiTuning's
+//       tables) for the oscilator, one harmonics update whatever the shape
+//-----------------------------------------------------------------------------
+void MiOsc::setIncrement(double increment) {
+    m_increment = increment;
+    double rate = increment * m_tune;
+    if (rate <= 0.0) return;
 
-    m_sine.setFrequency(freq);
-    m_blitSaw.setFrequency(freq);
-    m_blitSquare.setFrequency(freq);
+    m_rate = rate;
+    m_period = 1.0 / rate;
+    updateHarmonics();
 }
 
 //-----------------------------------------------------------------------------
@@ -60,7 +346,7 @@ void MiOsc::setFrequency(double freq) {
 //-----------------------------------------------------------------------------
 void MiOsc::setTuning(double tune) {
     m_tune = tune;
-    setFrequency(m_freq);
+    setIncrement(m_increment);
 }
 
 //-----------------------------------------------------------------------------
@@ -68,24 +354,16 @@ void MiOsc::setTuning(double tune) {
 // desc: generate a sample of output
 //-----------------------------------------------------------------------------
 StkFloat MiOsc::tick() {
-    StkFloat sample;
-
     switch (m_waveShape) {
       case SINE:
-        sample = m_sine.tick();
-        break;
+        return tickShape<SINE>();
       case SAW:
-        sample = m_blitSaw.tick();
-        break;
+        return tickShape<SAW>();
       case SQUARE:
-        sample = m_blitSquare.tick();
-        break;
+        return tickShape<SQUARE>();
       default:
         return 0;
     }
-
-    sample *= m_oscVolume;
-    return sample;
 }
 
 //-----------------------------------------------------------------------------
@@ -93,8 +371,74 @@ StkFloat MiOsc::tick() {
 // desc: set the number of harmonics generated by BLIT algorithms (saw & square)
 //-----------------------------------------------------------------------------
 void MiOsc::setNHarmonics(int nHarmonics) {
-    m_blitSaw.setHarmonics(nHarmonics);
-    m_blitSquare.setHarmonics(nHarmonics);
+    m_nHarmonics = nHarmonics;
+    updateHarmonics();
+
+    // minimizes the saw's initial DC offset (see BlitSaw::setHarmonics())
+    m_sawState = -0.5 * m_sawA;
+}
+
+//-----------------------------------------------------------------------------
+// name: updateHarmonics()
+// desc: BLIT parameters for the current period, M is odd for the saw and
+//       even for the square (a bipolar BLIT at half the period), 0
+//       harmonics means all up to half the sample rate
+//-----------------------------------------------------------------------------
+void MiOsc::updateHarmonics() {
+    if (m_nHarmonics <= 0) {
+        m_sawM = 2 * (unsigned int) floor(0.5 * m_period) + 1;
+        m_squareM = 2 * ((unsigned int) floor(0.25 * m_period) + 1);
+    }
+    else {
+        m_sawM = 2 * m_nHarmonics + 1;
+        m_squareM = 2 * (m_nHarmonics + 1);
+    }
+
+    m_sawA = m_sawM / m_period;
+    m_squareA = m_squareM / (0.5 * m_period);
+}
+
+//-----------------------------------------------------------------------------
+// name: isAudible()
+// desc: false when the oscillator can only output zeros (no volume, or a
+//       wave shape tick() doesn't generate)
+//-----------------------------------------------------------------------------
+bool MiOsc::isAudible() {
+    if (m_oscVolume == 0.0) return false;
+    return m_waveShape == SINE || m_waveShape == SAW || m_waveShape == SQUARE;
+}
+
+//-----------------------------------------------------------------------------
+// name: getKernelShape()
+// desc: the render kernel slot for this oscillator, its wave shape or
+//       OSC_OFF when it can't be heard
+//-----------------------------------------------------------------------------
+int MiOsc::getKernelShape() {
+    return isAudible() ? m_waveShape : OSC_OFF;
+}
+
+//-----------------------------------------------------------------------------
+// name: getWaveShape()
+// desc: get the wave shape of the oscillator
+//-----------------------------------------------------------------------------
+int MiOsc::getWaveShape() {
+    return m_waveShape;
+}
+
+//-----------------------------------------------------------------------------
+// name: getVolume()
+// desc: get the volume of the oscillator
+//-----------------------------------------------------------------------------
+StkFloat MiOsc::getVolume() {
+    return m_oscVolume;
+}
+
+//-----------------------------------------------------------------------------
+// name: getTuning()
+// desc: get the tuning of the oscillator
+//-----------------------------------------------------------------------------
+double MiOsc::getTuning() {
+    return m_tune;
 }
 
   //---------//
@@ -106,18 +450,21 @@ void MiOsc::setNHarmonics(int nHarmonics) {
 // desc: constructor
 //-----------------------------------------------------------------------------
 MiVoice::MiVoice( int numOscillators, double freqRangeLow, double freqRangeHigh ) { 
+    if (numOscillators > MAX_OSCILLATORS) numOscillators = MAX_OSCILLATORS;
+
     // generate oscillators
     for( int i = 0; i < numOscillators; i++) {
-        MiOsc* osc = new MiOsc();
+        MiOsc* osc = createInArena<MiOsc>();
         m_oscillators.push_back(osc);
     }
 
-    // set adsr times
-    m_A = 0.01;
-    m_D = 0.2;
-    m_S = 0.5;
-    m_R = 0.5;
-    m_adsr.setAllTimes(m_A, m_D, m_S, m_R);
+    // set adsr times, until there is a patch to follow
+    m_adsr.setAllTimes(0.01, 0.2, 0.5, 0.5);
+    m_patch = NULL;
+    m_patchVersion = 0;
+    m_envelopeVersion = 0;
+    m_tuningVersion = 0;
+    m_envelope.resize(StkContext::current()->blockSize(), 1, 0.0);
 
     // set min and max frequencies
     m_freqRangeLow = freqRangeLow;  
@@ -126,14 +473,23 @@ MiVoice::MiVoice( int numOscillators, double freqRangeLow, double freqRangeHigh
     // set class variables
     m_numOscillators = numOscillators;
     m_note = -1;
+    m_key = 60;
     m_playing = false;
+    m_nHarmonics = 0;
+
+    // every oscillator starts out audible
+    m_oscPlan.resize(numOscillators, 0);
+    updatePlan();
 }
 
 //-----------------------------------------------------------------------------
 // name: ~MiVoice()
 // desc: destructor
 //-----------------------------------------------------------------------------
-MiVoice::~MiVoice() { }
+MiVoice::~MiVoice() {
+    for (int i = 0; i < m_numOscillators; i++)
+        destroyOutsideArena(m_oscillators[i]);
+}
 
 //-----------------------------------------------------------------------------
 // name: setFreqRange()
@@ -145,6 +501,81 @@ void MiVoice::setFreqRange( double freqRangeLow, double freqRangeHigh ) {
     m_freqRangeHigh = freqRangeHigh;
 }
 
+//-----------------------------------------------------------------------------
+// name: setPatch()
+// desc: follow a synth's patch, the voice catches up with it whenever it
+//       plays or renders
+//-----------------------------------------------------------------------------
+void MiVoice::setPatch(const MiPatch* patch) {
+    m_patch = patch;
+    m_patchVersion = 0;
+    m_envelopeVersion = 0;
+    m_tuningVersion = 0;
+}
+
+//-----------------------------------------------------------------------------
+// name: updatePatch()
+// desc: catch up with whatever has changed in the patch since the voice last
+//       looked.  Only settings that differ are touched, harmonics first, then
+//       each oscillator's shape, volume and tuning.
+//-----------------------------------------------------------------------------
+void MiVoice::updatePatch() {
+    if (m_patch == NULL || m_patchVersion == m_patch->getVersion()) return;
+    m_patchVersion = m_patch->getVersion();
+
+    if (m_envelopeVersion != m_patch->getEnvelopeVersion()) {
+        m_envelopeVersion = m_patch->getEnvelopeVersion();
+        if (m_adsr.getCurve() != m_patch->getADSRCurve()) m_adsr.setCurve(m_patch->getADSRCurve());
+        m_patch->applyEnvelope(m_adsr);
+    }
+
+    if (m_tuningVersion != m_patch->getTuningVersion()) {
+        m_tuningVersion = m_patch->getTuningVersion();
+        retune();
+    }
+
+    if (m_nHarmonics != m_patch->getNHarmonics()) {
+        m_nHarmonics = m_patch->getNHarmonics();
+        for (int i = 0; i < m_numOscillators; i++)
+            m_oscillators[i]->setNHarmonics(m_nHarmonics);
+    }
+
+    bool replan = false;
+    for (int i = 0; i < m_numOscillators; i++) {
+        MiOsc* osc = m_oscillators[i];
+        if (osc->getWaveShape() != m_patch->getWaveShape(i)) {
+            osc->setWaveShape(m_patch->getWaveShape(i));
+            replan = true;
+        }
+        if (osc->getVolume() != m_patch->getOscVolume(i)) {
+            osc->setVolume(m_patch->getOscVolume(i));
+            replan = true;
+        }
+        if (osc->getTuning() != m_patch->getOscTuning(i))
+            osc->setTuning(m_patch->getOscTuning(i));
+    }
+    if (replan) updatePlan();
+}
+
+//-----------------------------------------------------------------------------
+// name: retune()
+// desc: set the oscillators to the last note played, as the patch's note
+//       tables and pitch bend have it
+//-----------------------------------------------------------------------------
+void MiVoice::retune() {
+    if (m_patch == NULL) {
+        for (int i = 0; i < m_numOscillators; i++)
+            m_oscillators[i]->setFrequency(XFun::midi2freq(m_key));
+        return;
+    }
+
+    // each voice has a few oscillators, all on the same note
+    double increment = m_patch->getIncrement(m_key);
+    for (int i = 0; i < m_numOscillators; i++) {
+        m_oscillators[i]->setIncrement(increment);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // name: getNote()
 // desc: return the note that this voice is playing (or -1 if not playing)
@@ -153,18 +584,41 @@ int MiVoice::getNote() {
     return m_note;
 }
 
+//-----------------------------------------------------------------------------
+// name: getKey()
+// desc: return the last note played on this voice, it stays put through the
+//       release (middle C before the first note)
+//-----------------------------------------------------------------------------
+int MiVoice::getKey() {
+    return m_key;
+}
+
+//-----------------------------------------------------------------------------
+// name: getEnvelope()
+// desc: return the current level of the voice's envelope
+//-----------------------------------------------------------------------------
+StkFloat MiVoice::getEnvelope() {
+    return m_adsr.lastOut();
+}
+
+//-----------------------------------------------------------------------------
+// name: isActive()
+// desc: true while the envelope is running (note held or releasing)
+//-----------------------------------------------------------------------------
+bool MiVoice::isActive() {
+    return m_adsr.getState() != ADSR::IDLE;
+}
+
 //-----------------------------------------------------------------------------
 // name: playNote()
 // desc: play note
 //-----------------------------------------------------------------------------
 void MiVoice::playNote(int note, int velocity) {
-    // each voice has a few oscillators
-    for (int i = 0; i < m_numOscillators; i++) {
-        // set the freq on the oscillators
-        m_oscillators.at(i)->setFrequency( XFun::midi2freq(note) );
-    }
+    updatePatch();
 
     m_note = note;
+    m_key = note;
+    retune();
     m_playing = true;
     m_adsr.keyOn();
 }
@@ -174,6 +628,7 @@ void MiVoice::playNote(int note, int velocity) {
 // desc: stop any note playing on this voice
 //-----------------------------------------------------------------------------
 void MiVoice::stopNote() {
+    updatePatch();
     m_playing = false;
     m_note = -1;
     m_adsr.keyOff();
@@ -186,11 +641,12 @@ void MiVoice::stopNote() {
 StkFloat MiVoice::tick() {
     StkFloat returnSamp = 0;
     StkFloat tickSamp = 0;
+    updatePatch();
 
-    // each voice has a few oscillators
-    for (int i = 0; i < m_numOscillators; i++) {
+    // each voice has a few oscillators, only the audible ones are ticked
+    for (int i = 0; i < m_numPlanned; i++) {
         // tick the oscillators
-        tickSamp = m_oscillators.at(i)->tick();
+        tickSamp = m_oscillators[m_oscPlan[i]]->tick();
 
         // sum the oscillators
         returnSamp = returnSamp + tickSamp;
@@ -201,49 +657,429 @@ StkFloat MiVoice::tick() {
 }
 
 //-----------------------------------------------------------------------------
-// name: setADSR()
-// desc: set attack, decay, susatain, and release at once
+// name: MiVoice::renderBlock()
+// desc: add nFrames of output to a channel of frames, the envelope for the
+//       whole block is generated in one go
 //-----------------------------------------------------------------------------
-void MiVoice::setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R) {
-    m_A = A;
-    m_D = D;
-    m_S = S;
-    m_R = R;
-    m_adsr.setAllTimes(A, D, S, R);
+void MiVoice::renderBlock(StkFrames& frames, unsigned int nFrames, unsigned int channel) {
+    updatePatch();
+    m_envelope.resize(nFrames, 1);
+    m_adsr.tick(m_envelope);
+    m_kernel(this, &m_envelope[0], &frames[channel], frames.channels(), nFrames);
 }
 
 //-----------------------------------------------------------------------------
-// name: SetWaveShape()
-// desc: set the wave shape for the oscilator
+// name: MiVoice::renderKernel()
+// desc: render kernel for a three oscillator voice with the wave shapes
+//       fixed at compile time, so the loop has no branches and every tick
+//       inlines.  OSC_OFF oscillators drop out of the loop entirely.
 //-----------------------------------------------------------------------------
-void MiVoice::setWaveShape(int oscNum, int waveShape) {
-    m_oscillators.at(oscNum)->setWaveShape(waveShape);
+template <int S0, int S1, int S2>
+void MiVoice::renderKernel(MiVoice* voice, const StkFloat* envelope, StkFloat* samples,
+                           unsigned int hop, unsigned int nFrames) {
+    MiOsc* osc0 = voice->m_oscillators[0];
+    MiOsc* osc1 = voice->m_oscillators[1];
+    MiOsc* osc2 = voice->m_oscillators[2];
+
+    for (unsigned int i = 0; i < nFrames; i++, samples += hop) {
+        StkFloat returnSamp = osc0->tickShape<S0>() + osc1->tickShape<S1>() + osc2->tickShape<S2>();
+        *samples += envelope[i] * returnSamp;
+    }
 }
 
 //-----------------------------------------------------------------------------
-// name: SetOscVolume()
-// desc: set the volume of the oscilator
+// name: MiVoice::renderPlanned()
+// desc: render kernel for any number of oscillators, ticking the audible
+//       ones from the plan
 //-----------------------------------------------------------------------------
-void MiVoice::setOscVolume(int oscNum, StkFloat volume) {
-    m_oscillators.at(oscNum)->setVolume(volume);
+void MiVoice::renderPlanned(MiVoice* voice, const StkFloat* envelope, StkFloat* samples,
+                            unsigned int hop, unsigned int nFrames) {
+    for (unsigned int i = 0; i < nFrames; i++, samples += hop) {
+        StkFloat returnSamp = 0;
+
+        // each voice has a few oscillators, only the audible ones are ticked
+        for (int j = 0; j < voice->m_numPlanned; j++) {
+            returnSamp += voice->m_oscillators[voice->m_oscPlan[j]]->tick();
+        }
+
+        *samples += envelope[i] * returnSamp;
+    }
+}
+
+// every combination of kernel shapes for three oscillators, indexed
+// [osc 1][osc 2][osc 3] by SINE, SAW, SQUARE, OSC_OFF
+#define MI_KERNELS_3(S0, S1) { &MiVoice::renderKernel<S0, S1, SINE>, &MiVoice::renderKernel<S0, S1, SAW>, \
+                               &MiVoice::renderKernel<S0, S1, SQUARE>, &MiVoice::renderKernel<S0, S1, OSC_OFF> }
+#define MI_KERNELS_2(S0) { MI_KERNELS_3(S0, SINE), MI_KERNELS_3(S0, SAW), \
+                           MI_KERNELS_3(S0, SQUARE), MI_KERNELS_3(S0, OSC_OFF) }
+const MiVoice::Kernel MiVoice::s_kernels[NUM_KERNEL_SHAPES][NUM_KERNEL_SHAPES][NUM_KERNEL_SHAPES] = {
+    MI_KERNELS_2(SINE), MI_KERNELS_2(SAW), MI_KERNELS_2(SQUARE), MI_KERNELS_2(OSC_OFF)
+};
+#undef MI_KERNELS_2
+#undef MI_KERNELS_3
+
+//-----------------------------------------------------------------------------
+// name: updatePlan()
+// desc: rebuild the list of oscillators tick() runs, leaving out the ones
+//       that can only contribute silence, and pick the render kernel for
+//       the current wave shapes.  Only called when a volume or wave shape
+//       changes.
+//-----------------------------------------------------------------------------
+void MiVoice::updatePlan() {
+    int numPlanned = 0;
+    for (int i = 0; i < m_numOscillators; i++) {
+        if (m_oscillators.at(i)->isAudible()) m_oscPlan[numPlanned++] = i;
+    }
+    m_numPlanned = numPlanned;
+
+    // the specialized kernels cover the usual three oscillators
+    if (m_numOscillators == 3) {
+        m_kernel = s_kernels[m_oscillators[0]->getKernelShape()]
+                            [m_oscillators[1]->getKernelShape()]
+                            [m_oscillators[2]->getKernelShape()];
+    }
+    else {
+        m_kernel = &MiVoice::renderPlanned;
+    }
 }
+
+  //----------------//
+ // MiStageSilence //
+//----------------//
+
 //-----------------------------------------------------------------------------
-// name: setOscTuning()
-// desc: set the tuning of the oscillator
+// name: MiStageSilence()
+// desc: constructor, stages start out silent with no hold time
 //-----------------------------------------------------------------------------
-void MiVoice::setOscTuning(int oscNum, double oscTuning) {
-    m_oscillators.at(oscNum)->setTuning(oscTuning);
+MiStageSilence::MiStageSilence() {
+    m_silent = true;
+    m_hold = 0;
+    m_countdown = 0;
 }
 
 //-----------------------------------------------------------------------------
-// name: setNHarmonics() 
-// desc: set the number of harmonics generated by BLIT algorithms (saw & square)
+// name: setHold()
+// desc: minimum number of frames the stage keeps running after its input
+//       goes quiet (i.e. the longest delay inside the stage)
 //-----------------------------------------------------------------------------
-void MiVoice::setNHarmonics(int nHarmonics) {
-    for (int i = 0; i < m_numOscillators; i++) {
-        m_oscillators.at(i)->setNHarmonics(nHarmonics);
+void MiStageSilence::setHold(unsigned long holdFrames) {
+    m_hold = holdFrames;
+}
+
+//-----------------------------------------------------------------------------
+// name: wake()
+// desc: call with the peak of the stage input before processing a block,
+//       returns true if the stage has to be processed
+//-----------------------------------------------------------------------------
+bool MiStageSilence::wake(StkFloat inputPeak) {
+    if (inputPeak > SILENCE_THRESHOLD) {
+        m_silent = false;
+        m_countdown = m_hold;
     }
-    m_nHarmonics = nHarmonics;
+    return !m_silent;
+}
+
+//-----------------------------------------------------------------------------
+// name: settle()
+// desc: call after processing a block with the input and output peaks,
+//       returns true when the stage just went silent (its state can be cleared)
+//-----------------------------------------------------------------------------
+bool MiStageSilence::settle(StkFloat inputPeak, StkFloat outputPeak, unsigned int nFrames) {
+    if (inputPeak > SILENCE_THRESHOLD) return false;
+
+    m_countdown -= nFrames;
+    if (m_countdown > 0 || outputPeak > SILENCE_THRESHOLD) return false;
+
+    m_silent = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: isSilent()
+// desc: true while the stage is skipped
+//-----------------------------------------------------------------------------
+bool MiStageSilence::isSilent() const {
+    return m_silent;
+}
+
+  //------------//
+ // MiStageMix //
+//------------//
+
+//-----------------------------------------------------------------------------
+// name: MiStageMix()
+// desc: constructor, starts out settled at mix (no ramp)
+//-----------------------------------------------------------------------------
+MiStageMix::MiStageMix(StkFloat mix) {
+    m_mix = mix;
+    m_current = mix;
+    m_start = mix;
+    m_step = 0.0;
+    m_active = mix > 0.0;
+}
+
+//-----------------------------------------------------------------------------
+// name: setMix()
+// desc: set the target mix, reached by the end of the next block.  A non
+//       zero mix puts the stage back in the plan straight away, a zero mix
+//       only takes it out once the ramp down has played.
+//-----------------------------------------------------------------------------
+void MiStageMix::setMix(StkFloat mix) {
+    m_mix = mix;
+    if (mix > 0.0) m_active = true;
+}
+
+//-----------------------------------------------------------------------------
+// name: begin()
+// desc: start a block of nFrames, returns false if the stage is out of the
+//       plan and can be skipped (its output would be the dry signal)
+//-----------------------------------------------------------------------------
+bool MiStageMix::begin(unsigned int nFrames) {
+    if (!m_active) return false;
+
+    StkFloat target = m_mix;
+    m_start = m_current;
+    m_step = (target - m_current) / nFrames;
+    m_current = target;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: end()
+// desc: finish a block, returns true if the stage just dropped out of the
+//       plan so the caller can clear its state
+//-----------------------------------------------------------------------------
+bool MiStageMix::end() {
+    if (m_current > 0.0 || m_mix > 0.0) return false;
+
+    m_active = false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: isActive()
+// desc: true while the stage is in the plan, without starting a block
+//-----------------------------------------------------------------------------
+bool MiStageMix::isActive() const {
+    return m_active;
+}
+
+//-----------------------------------------------------------------------------
+// name: start()
+// desc: mix at the start of the current block
+//-----------------------------------------------------------------------------
+StkFloat MiStageMix::start() const {
+    return m_start;
+}
+
+//-----------------------------------------------------------------------------
+// name: step()
+// desc: per frame change of the mix across the current block
+//-----------------------------------------------------------------------------
+StkFloat MiStageMix::step() const {
+    return m_step;
+}
+
+  //--------------//
+ // MiFilterBank //
+//--------------//
+
+//-----------------------------------------------------------------------------
+// name: MiFilterTable()
+// desc: constructor, builds the tables for the sample rate of the current
+//       context
+//-----------------------------------------------------------------------------
+MiFilterTable::MiFilterTable() {
+    m_context = StkContext::current();
+    build();
+}
+
+//-----------------------------------------------------------------------------
+// name: build()
+// desc: fill the tables, one entry per controller step.  Cutoff positions
+//       carry on past 127 up to FILTER_CUTOFF_MAX so modulated cutoffs can
+//       be looked up too.
+//-----------------------------------------------------------------------------
+void MiFilterTable::build() {
+    StkFloat sampleRate = m_context->sampleRate();
+    m_maxPosition = (FILTER_CUTOFF_MAX * sampleRate - 20.0) * 128.0 / 10000.0;
+
+    // integrator gain tan(PI * fc / fs), plus a guard entry to interpolate into
+    int numCutoffs = (int) m_maxPosition + 2;
+    m_gain.resize(numCutoffs);
+    for (int i = 0; i < numCutoffs; i++) {
+        m_gain[i] = SVFilter::prewarp(FILTER_CC_CUTOFF(i), sampleRate);
+    }
+
+    // bandwidth (Hz) of poles at each resonance radius, 0 to 128 plus a guard entry
+    m_bandwidth.resize(130);
+    for (int i = 0; i < 130; i++) {
+        m_bandwidth[i] = -log(FILTER_CC_RADIUS(i)) * sampleRate / PI;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: cutoffPosition()
+// desc: controller position for a cutoff in Hz (FILTER_CC_CUTOFF inverted),
+//       clamped to the table
+//-----------------------------------------------------------------------------
+StkFloat MiFilterTable::cutoffPosition(StkFloat cutoff) const {
+    StkFloat position = (cutoff - 20.0) * 128.0 / 10000.0;
+    if (position < 0.0) return 0.0;
+    if (position > m_maxPosition) return m_maxPosition;
+    return position;
+}
+
+//-----------------------------------------------------------------------------
+// name: resonancePosition()
+// desc: controller position for a pole radius (FILTER_CC_RADIUS inverted),
+//       clamped to the table
+//-----------------------------------------------------------------------------
+StkFloat MiFilterTable::resonancePosition(StkFloat radius) const {
+    StkFloat position = radius * 130.0 - 1.0;
+    if (position < 0.0) return 0.0;
+    if (position > 128.0) return 128.0;
+    return position;
+}
+
+//-----------------------------------------------------------------------------
+// name: gain()
+// desc: integrator gain at a cutoff position
+//-----------------------------------------------------------------------------
+StkFloat MiFilterTable::gain(StkFloat cutoffPosition) const {
+    int index = (int) cutoffPosition;
+    StkFloat alpha = cutoffPosition - index;
+    return m_gain[index] + alpha * (m_gain[index + 1] - m_gain[index]);
+}
+
+//-----------------------------------------------------------------------------
+// name: damping()
+// desc: damping (k = 1 / Q) that gives the resonance position's bandwidth at
+//       the cutoff position
+//-----------------------------------------------------------------------------
+StkFloat MiFilterTable::damping(StkFloat cutoffPosition, StkFloat resonancePosition) const {
+    int index = (int) resonancePosition;
+    StkFloat alpha = resonancePosition - index;
+    StkFloat bandwidth = m_bandwidth[index] + alpha * (m_bandwidth[index + 1] - m_bandwidth[index]);
+    return bandwidth / FILTER_CC_CUTOFF(cutoffPosition);
+}
+
+//-----------------------------------------------------------------------------
+// name: MiFilterBank()
+// desc: constructor, every lane starts out cleared as a bandpass without
+//       coefficients
+//-----------------------------------------------------------------------------
+MiFilterBank::MiFilterBank(int numLanes) {
+    m_numLanes = numLanes;
+    m_type = SVFilter::BANDPASS;
+    m_g.resize(numLanes, -1.0);
+    m_k.resize(numLanes, 1.0);
+    m_a1.resize(numLanes, 0.0);
+    m_a2.resize(numLanes, 0.0);
+    m_a3.resize(numLanes, 0.0);
+    m_m0.resize(numLanes, 0.0);
+    m_m1.resize(numLanes, 0.0);
+    m_m2.resize(numLanes, 0.0);
+    m_ic1.resize(numLanes, 0.0);
+    m_ic2.resize(numLanes, 0.0);
+}
+
+//-----------------------------------------------------------------------------
+// name: setType()
+// desc: set the response of every lane (SVFilter::LOWPASS, BANDPASS,
+//       HIGHPASS or NOTCH)
+//-----------------------------------------------------------------------------
+void MiFilterBank::setType(int type) {
+    m_type = type;
+    for (int lane = 0; lane < m_numLanes; lane++) setMix(lane);
+}
+
+//-----------------------------------------------------------------------------
+// name: setCoefficients()
+// desc: set one lane's integrator gain (tan(PI * fc / fs), see
+//       MiFilterTable) and damping.  Nothing is recomputed if the lane is
+//       already there.
+//-----------------------------------------------------------------------------
+void MiFilterBank::setCoefficients(int lane, StkFloat gain, StkFloat damping) {
+    if (gain == m_g[lane] && damping == m_k[lane]) return;
+
+    m_g[lane] = gain;
+    m_k[lane] = damping;
+    m_a1[lane] = 1.0 / (1.0 + gain * (gain + damping));
+    m_a2[lane] = gain * m_a1[lane];
+    m_a3[lane] = gain * m_a2[lane];
+    setMix(lane);
+}
+
+//-----------------------------------------------------------------------------
+// name: setMix()
+// desc: output = m0 * input + m1 * band + m2 * low, for the lane's damping
+//-----------------------------------------------------------------------------
+void MiFilterBank::setMix(int lane) {
+    StkFloat k = m_k[lane];
+    switch (m_type) {
+      case SVFilter::LOWPASS:
+        m_m0[lane] = 0.0; m_m1[lane] = 0.0; m_m2[lane] = 1.0;
+        break;
+      case SVFilter::HIGHPASS:
+        m_m0[lane] = 1.0; m_m1[lane] = -k; m_m2[lane] = -1.0;
+        break;
+      case SVFilter::NOTCH:
+        m_m0[lane] = 1.0; m_m1[lane] = -k; m_m2[lane] = 0.0;
+        break;
+      case SVFilter::BANDPASS:
+      default:
+        m_m0[lane] = 0.0; m_m1[lane] = k; m_m2[lane] = 0.0;
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: clear()
+// desc: clear the state of every lane
+//-----------------------------------------------------------------------------
+void MiFilterBank::clear() {
+    for (int lane = 0; lane < m_numLanes; lane++) {
+        m_ic1[lane] = 0.0;
+        m_ic2[lane] = 0.0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: MiFilterBank::tick()
+// desc: filter frames in place, channel n running through lane n.  The
+//       inner loop runs across the lanes so it vectorizes.
+//-----------------------------------------------------------------------------
+StkFrames& MiFilterBank::tick(StkFrames& frames) {
+#if defined(_STK_DEBUG_)
+    if (frames.channels() != (unsigned int) m_numLanes) {
+        Stk::handleError("MiFilterBank::tick(): StkFrames argument needs a channel per lane!", StkError::FUNCTION_ARGUMENT);
+    }
+#endif
+
+    StkFloat* samples = &frames[0];
+    const StkFloat* a1 = &m_a1[0];
+    const StkFloat* a2 = &m_a2[0];
+    const StkFloat* a3 = &m_a3[0];
+    const StkFloat* m0 = &m_m0[0];
+    const StkFloat* m1 = &m_m1[0];
+    const StkFloat* m2 = &m_m2[0];
+    StkFloat* ic1 = &m_ic1[0];
+    StkFloat* ic2 = &m_ic2[0];
+    int numLanes = m_numLanes;
+
+    for (unsigned int i = 0; i < frames.frames(); i++, samples += numLanes) {
+        for (int lane = 0; lane < numLanes; lane++) {
+            StkFloat v0 = samples[lane];
+            StkFloat v3 = v0 - ic2[lane];
+            StkFloat v1 = a1[lane] * ic1[lane] + a2[lane] * v3;
+            StkFloat v2 = ic2[lane] + a2[lane] * ic1[lane] + a3[lane] * v3;
+            ic1[lane] = Stk::undenormalize(2.0 * v1 - ic1[lane]);
+            ic2[lane] = Stk::undenormalize(2.0 * v2 - ic2[lane]);
+            samples[lane] = m0[lane] * v0 + m1[lane] * v1 + m2[lane] * v2;
+        }
+    }
+    return frames;
 }
 
   //---------//
@@ -251,29 +1087,59 @@ void MiVoice::setNHarmonics(int nHarmonics) {
 //---------//
 
 //-----------------------------------------------------------------------------
-// name: MiSynth()
-// desc: constructor
+// name: echoMaximumDelay()
+// desc: delay line length (in samples) echo tap n needs at sampleRate, n
+//       times the longest echo
+//-----------------------------------------------------------------------------
+static unsigned long echoMaximumDelay(int tap, StkFloat sampleRate) {
+    return (unsigned long)(tap * ECHO_LENGTH_MAX * sampleRate);
+}
+
 //-----------------------------------------------------------------------------
-MiSynth::MiSynth( int numVoices) { 
+// name: MiSynth()
+// desc: constructor, runs at the sample rate and block size of the current
+//       context (see StkContext)
+//-----------------------------------------------------------------------------
+MiSynth::MiSynth( int numVoices)
+    : m_context(StkContext::current()), m_blockSize(m_context->blockSize()),
+      m_echo1(echoMaximumDelay(1, m_context->sampleRate())),
+      m_echo2(echoMaximumDelay(2, m_context->sampleRate())),
+      m_echo3(echoMaximumDelay(3, m_context->sampleRate())),
+      m_echo4(echoMaximumDelay(4, m_context->sampleRate())) {
     std::cout << "MiSynth inbound with " << numVoices << " voices\n";
 
-    // add voices
+    // add voices, they look their notes up in the synth's tuning
+    m_patch.setTuning(&m_tuning);
     for( int i = 0; i < numVoices; i++) {
-        MiVoice* voice = new MiVoice();
+        MiVoice* voice = createInArena<MiVoice>();
+        voice->setPatch(&m_patch);
         m_voices.push_back(voice);
     }
 
     m_numVoices = numVoices;
-    m_numLFOs = 2;
+    m_numLFOs = NUM_LFOS;
     m_muted = false;
     m_volume = 0.9;
     m_voiceSelect = 0;
-    m_filterMix = 0.1;
-    m_reverbMix = 0.9;
+    m_filterMix = MiStageMix(0.1);
+    m_reverbMix = MiStageMix(0.9);
     m_reverbType = NREV;
-
-    // Filter set resonance
-    m_biquad.setResonance( 440.0, 0.98, true );
+    m_tremeloMix = MiStageMix(0.0);
+    m_monoBuffer.resize(m_blockSize, 1, 0.0);
+    m_filterBuffer.resize(m_blockSize, 1, 0.0);
+    m_wetBuffer.resize(m_blockSize, 1, 0.0);
+    m_leftBuffer.resize(m_blockSize, 1, 0.0);
+    m_rightBuffer.resize(m_blockSize, 1, 0.0);
+
+    // Filter set resonance, one filter per voice
+    m_filterBank = MiFilterBank(numVoices);
+    m_voiceBuffer.resize(m_blockSize, numVoices, 0.0);
+    m_filterCutoff = m_filterTable.cutoffPosition(440.0);
+    m_filterResonance = m_filterTable.resonancePosition(0.98);
+    m_filterCutoffTarget = m_filterCutoff;
+    m_filterResonanceTarget = m_filterResonance;
+    m_filterKeyTrack = 0.0;
+    m_filterEnvAmount = 0.0;
 
     // Reverb setup
     m_prcRev.setT60(5);
@@ -285,101 +1151,415 @@ MiSynth::MiSynth( int numVoices) {
 
     // Echo setup
     unsigned long del = 11000;
-    m_echoFeedback = 0.8;
-    m_echoMix = 0.5;
-    // 10 second maximum delay (in samples)
-    m_echo1.setMaximumDelay(44100 * 10);
-    m_echo2.setMaximumDelay(44100 * 10);
-    m_echo3.setMaximumDelay(44100 * 10);
-    m_echo4.setMaximumDelay(44100 * 10);
+    m_echoMix = MiStageMix(0.5);
     // set the delays
     m_echo1.setDelay(del);
     m_echo2.setDelay(del * 2);
     m_echo3.setDelay(del * 3);
     m_echo4.setDelay(del * 4);
+    m_echoLength = del;
+
+    // echoes ring out for as long as the longest path through the taps
+    m_echoSilence.setHold(m_echoLength * 5);
+    m_reverbSilence.setHold((unsigned long)(REVERB_HOLD_TIME * m_context->sampleRate()));
 
     // LFO setup
     for( int i = 0; i < m_numLFOs; i++) {
-        MiOsc* lfo = new MiOsc();
+        MiOsc* lfo = createInArena<MiOsc>();
         lfo->setFrequency(1.0);
         lfo->setWaveShape(SINE);
         lfo->setVolume(1.0);
         m_LFOs.push_back(lfo);
     }
+
+    // the effects stage starts out with the settings above
+    m_effects.echoLength = m_echoLength;
+    m_effects.echoMix = 0.5;
+    m_effects.echoFeedback = 0.8;
+    m_effects.reverbType = m_reverbType;
+    m_effects.reverbClears = 0;
+    m_effects.reverbSize = -1.0;
+    m_effects.roomSize = 0.95;
+    m_prcRev.getCombCoefficients(5, m_effects.prcCombs);
+    m_jcRev.getCombCoefficients(5, m_effects.jcCombs);
+    m_nRev.getCombCoefficients(5, m_effects.nCombs);
+    m_effects.reverbMix = 0.9;
+    m_effects.tremeloMix = 0.0;
+    for (int i = 0; i < NUM_LFOS; i++) {
+        m_effects.lfoFrequency[i] = 1.0;
+        m_effects.lfoWaveShape[i] = SINE;
+        m_effects.lfoDepth[i] = 1.0;
+    }
+    m_effects.panMix = 0.0;
+    m_effects.masterVolume = 1.0;
+    publishEffects();
+    m_appliedEffects = m_effects;
 }
 
 //-----------------------------------------------------------------------------
 // name: ~MiSynth()
 // desc: destructor
 //-----------------------------------------------------------------------------
-MiSynth::~MiSynth() { }
+MiSynth::~MiSynth() {
+    for (int i = 0; i < m_numVoices; i++)
+        destroyOutsideArena(m_voices[i]);
+    for (int i = 0; i < m_numLFOs; i++)
+        destroyOutsideArena(m_LFOs[i]);
+}
+
+//-----------------------------------------------------------------------------
+// name: arenaSize()
+// desc: bytes of arena (see StkArena) a synth with numVoices needs at
+//       sampleRate: the echo taps (10 times the longest echo), the
+//       reverbs' delay lines (under 8 seconds of samples between them) and
+//       each voice with its oscillators and buffers
+//-----------------------------------------------------------------------------
+size_t MiSynth::arenaSize(int numVoices, StkFloat sampleRate) {
+    StkFloat second = sampleRate * sizeof(StkFloat);
+    return (size_t)((10 * ECHO_LENGTH_MAX + 8) * second) + numVoices * 16384;
+}
 
 //-----------------------------------------------------------------------------
 // name: MiSynth::tick()
-// desc: generate a sample of output
+// desc: fill a stereo StkFrames with output, rendered in blocks of at most
+//       the context's block size
 //-----------------------------------------------------------------------------
-StkFloat MiSynth::tick() {
-    StkFloat sumSamp = 0;
-    StkFloat tickSamp = 0;
-    StkFloat filterSamp = 0;
-    StkFloat filterMixedSamp = 0;
-    StkFloat revSamp = 0;
-    StkFloat revMixedSamp = 0;
+StkFrames& MiSynth::tick(StkFrames& frames) {
+#if defined(_STK_DEBUG_)
+    if (frames.channels() != 2) {
+        Stk::handleError("MiSynth::tick(): StkFrames argument must be stereo!", StkError::FUNCTION_ARGUMENT);
+    }
+#endif
+
+    unsigned int nFrames = frames.frames();
+    for (unsigned int offset = 0; offset < nFrames; offset += m_blockSize) {
+        unsigned int blockFrames = nFrames - offset;
+        if (blockFrames > m_blockSize) blockFrames = m_blockSize;
+        StkFramesView block(frames, offset, blockFrames);
+        renderBlock(block);
+    }
+    return frames;
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::renderBlock()
+// desc: render one block into frames, the voice stage straight into the
+//       effects stage.  Each stage tracks the peak of its input and tail,
+//       and once both have decayed below SILENCE_THRESHOLD the stage is
+//       skipped and zero-filled until new input arrives.  Stages whose mix
+//       is zero are out of the plan and pass the dry signal straight
+//       through.
+//-----------------------------------------------------------------------------
+void MiSynth::renderBlock(StkFrames& frames) {
+    StkFramesView mono(m_monoBuffer, 0, frames.frames());
+    StkFloat peak = renderVoices(mono);
+    renderEffects(mono, peak, frames);
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::renderVoices()
+// desc: the voice stage: render the voices and the filter into a block of
+//       mono frames and return its peak.  It shares nothing with the effects
+//       stage but the block, so a pipeline (see MiEngine) can run it on
+//       another thread, a block or more ahead of renderEffects().
+//-----------------------------------------------------------------------------
+StkFloat MiSynth::renderVoices(StkFrames& monoFrames) {
+    unsigned int nFrames = monoFrames.frames();
+    StkFloat* mono = &monoFrames[0];
+    StkFloat* wet;
+    StkFloat inputPeak = 0;
+    StkFloat outputPeak = 0;
+    unsigned int i;
+
+    for (i = 0; i < nFrames; i++) mono[i] = 0.0;
+    m_filterBuffer.resize(nFrames, 1);
+    wet = &m_filterBuffer[0];
+
+    // sum the voices, idle voices contribute nothing and are skipped.  With
+    // the filter in the plan each voice renders into its own lane for the
+    // filter bank instead, and the lanes are summed for the dry signal.
+    bool filterOn = m_filterMix.begin(nFrames);
+    if (filterOn) m_voiceBuffer.resize(nFrames, m_numVoices, 0.0);
+    bool voicesActive = false;
+    for (int v = 0; v < m_numVoices; v++) {
+        MiVoice* voice = m_voices.at(v);
+        if (!voice->isActive()) continue;
+        voicesActive = true;
+        if (filterOn) voice->renderBlock(m_voiceBuffer, nFrames, v);
+        else voice->renderBlock(monoFrames, nFrames);
+    }
+    if (filterOn && voicesActive) StkSimd::mixDown(mono, &m_voiceBuffer[0], m_numVoices, nFrames);
+    inputPeak = voicesActive ? StkSimd::peak(mono, nFrames) : 0.0;
+
+    // Apply Filter, unless the mix leaves it out of the plan
+    if (filterOn) {
+        if (m_filterSilence.wake(inputPeak)) {
+            updateFilters(nFrames);
+            m_filterBank.tick(m_voiceBuffer);
+
+            for (i = 0; i < nFrames; i++) wet[i] = 0.0;
+            StkSimd::mixDown(wet, &m_voiceBuffer[0], m_numVoices, nFrames);
+            outputPeak = StkSimd::peak(wet, nFrames);
+            StkSimd::crossfade(mono, mono, wet, m_filterMix.start(), m_filterMix.step(), nFrames);
+            if (m_filterSilence.settle(inputPeak, outputPeak, nFrames)) m_filterBank.clear();
+            inputPeak = StkSimd::peak(mono, nFrames);
+        }
+        if (m_filterMix.end()) m_filterBank.clear();
+    }
+
+    return inputPeak;
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::renderEffects()
+// desc: the effects stage: run a block from renderVoices() (with its peak)
+//       through the echo, reverb and tremelo into stereo frames.  The mono
+//       block is used as scratch.
+//-----------------------------------------------------------------------------
+void MiSynth::renderEffects(StkFrames& monoFrames, StkFloat inputPeak, StkFrames& frames) {
+    unsigned int nFrames = frames.frames();
+    StkFloat* mono = &monoFrames[0];
+    StkFloat* wet;
+    StkFloat* left;
+    StkFloat* right;
+    StkFloat* out = &frames[0];
+    StkFloat outputPeak = 0;
+    StkFloat drySamp = 0;
     StkFloat echoSamp = 0;
-    StkFloat echoMixedSamp = 0;
-    StkFloat tremeloSamp = 0;
-    StkFloat returnSamp = 0;
+    StkFloat2 revSamp;
+    unsigned int i;
+
+    m_wetBuffer.resize(nFrames, 1);
+    wet = &m_wetBuffer[0];
+
+    // pick up any settings changed since the last block
+    applyEffects();
+    const MiEffectBlock& effects = m_appliedEffects;
+
+    // Apply echo, the four taps run as two pairs of lanes.  A mix ramp only
+    // starts once the echo is awake, so a change made while it sleeps still
+    // fades in.
+    if (m_echoMix.isActive() && m_echoSilence.wake(inputPeak)) {
+        m_echoMix.begin(nFrames);
+        StkFloat2 echoGain = { 1.0, effects.echoFeedback };
+        for (i = 0; i < nFrames; i++) {
+            drySamp = mono[i];
+            StkFloat2 echoTaps12 = { m_echo1.tick(drySamp), m_echo2.tick(drySamp) };
+            echoTaps12 *= echoGain;
+            echoSamp = echoTaps12[0] + echoTaps12[1];
+
+            StkFloat2 echoTaps34 = { m_echo3.tick(echoSamp), m_echo4.tick(drySamp) };
+            echoTaps34 *= effects.echoGain34;
+            wet[i] = echoSamp + echoTaps34[0] + echoTaps34[1];
+        }
+        outputPeak = StkSimd::peak(wet, nFrames);
+        StkSimd::crossfade(mono, mono, wet, m_echoMix.start(), m_echoMix.step(), nFrames);
+        if (m_echoSilence.settle(inputPeak, outputPeak, nFrames)) clearEchoes();
+        inputPeak = StkSimd::peak(mono, nFrames);
+        if (m_echoMix.end()) clearEchoes();
+    }
 
-    // each voice has a few oscillators
-    for (int i = 0; i < m_numVoices; i++) {
-        // tick the oscillators
-        tickSamp = m_voices.at(i)->tick();
+    // Apply Reverb, the bus is stereo from here on.  With the reverb out of
+    // the plan (or its tail gone) and a silent input there is nothing left
+    // to hear, so the rest of the chain is skipped along with it.
+    bool reverbOn = m_reverbMix.begin(nFrames);
+    bool reverbAwake = reverbOn && m_reverbSilence.wake(inputPeak);
+    if (!reverbAwake && inputPeak <= SILENCE_THRESHOLD) {
+        for (i = 0; i < 2 * nFrames; i++) out[i] = 0.0;
+        if (reverbOn && m_reverbMix.end()) clearReverbs();
+
+        // the tremelo LFO keeps running, so the next note meets it at the
+        // phase it would have had
+        if (m_tremeloMix.begin(nFrames)) {
+            for (i = 0; i < nFrames; i++) m_LFOs.at(0)->tick();
+            m_tremeloMix.end();
+        }
+        return;
+    }
 
-        // sum the voices
-        sumSamp = sumSamp + tickSamp;
+    // the stereo bus runs as separate left and right buffers until it is
+    // interleaved into the output
+    m_leftBuffer.resize(nFrames, 1);
+    m_rightBuffer.resize(nFrames, 1);
+    left = &m_leftBuffer[0];
+    right = &m_rightBuffer[0];
+    if (reverbAwake) {
+        for (i = 0; i < nFrames; i++) {
+            drySamp = mono[i];
+            switch (m_reverbType) {
+                case PRCREV:
+                    revSamp = m_prcRev.tickStereo(drySamp);
+                    break;
+                case FREEREV:
+                    revSamp = m_freeRev.tickStereo(drySamp);
+                    break;
+                case NREV:
+                    revSamp = m_nRev.tickStereo(drySamp);
+                    break;
+                case JCREV:
+                default:
+                    revSamp = m_jcRev.tickStereo(drySamp);
+                    break;
+            }
+            left[i] = revSamp[0];
+            right[i] = revSamp[1];
+        }
+        outputPeak = std::max(StkSimd::peak(left, nFrames), StkSimd::peak(right, nFrames));
+
+        // mix the reverb
+        StkFloat reverbMix = m_reverbMix.start();
+        StkFloat reverbStep = m_reverbMix.step();
+        StkSimd::crossfade(left, mono, left, reverbMix, reverbStep, nFrames);
+        StkSimd::crossfade(right, mono, right, reverbMix, reverbStep, nFrames);
+    }
+    else {
+        for (i = 0; i < nFrames; i++) left[i] = right[i] = mono[i];
+    }
+
+    if (m_tremeloMix.begin(nFrames)) {
+        // Tremelo! mixed in as a gain, 1 when dry
+        StkFloat tremeloMix = m_tremeloMix.start();
+        StkFloat tremeloStep = m_tremeloMix.step();
+        for (i = 0; i < nFrames; i++) {
+            tremeloMix += tremeloStep;
+            StkFloat tremelo = 0.5 + 0.5 * m_LFOs.at(0)->tick();
+            wet[i] = 1.0 + tremeloMix * (tremelo - 1.0);
+        }
+        StkSimd::multiply(left, wet, nFrames);
+        StkSimd::multiply(right, wet, nFrames);
+        m_tremeloMix.end();
     }
 
-    // Apply Filter
-    filterSamp = m_biquad.tick(sumSamp);
-    filterMixedSamp = m_filterMix * filterSamp + (1.0 - m_filterMix) * sumSamp;
+    // out with the goods
+    StkSimd::interleave(out, left, right, nFrames);
 
-    // Apply echo
-    // echoSamp += (1.0 - m_echoFeedback) * filterMixedSamp;
-    echoSamp += m_echo1.tick(filterMixedSamp);
-    echoSamp += m_echo2.tick(filterMixedSamp) * m_echoFeedback;
-    echoSamp += m_echo3.tick(echoSamp) * pow(m_echoFeedback, 2);
-    echoSamp += m_echo4.tick(filterMixedSamp) * pow(m_echoFeedback, 2);
+    if (reverbAwake && m_reverbSilence.settle(inputPeak, outputPeak, nFrames)) clearReverbs();
+    if (reverbOn && m_reverbMix.end()) clearReverbs();
+}
 
-    echoMixedSamp = m_echoMix * echoSamp + (1.0 - m_echoMix) * filterMixedSamp;
+//-----------------------------------------------------------------------------
+// name: MiSynth::updateFilters()
+// desc: glide the cutoff and resonance towards the knobs, then work out each
+//       voice's coefficients for this block from key tracking (octaves per
+//       octave from middle C) and the voice's envelope (octaves at full
+//       level).  Unmodulated voices take their terms straight from the
+//       table.
+//-----------------------------------------------------------------------------
+void MiSynth::updateFilters(unsigned int nFrames) {
+    StkFloat maxStep = FILTER_GLIDE_RATE * nFrames / m_context->sampleRate();
+    StkFloat step = m_filterCutoffTarget - m_filterCutoff;
+    if (step > maxStep) step = maxStep;
+    if (step < -maxStep) step = -maxStep;
+    m_filterCutoff += step;
+    step = m_filterResonanceTarget - m_filterResonance;
+    if (step > maxStep) step = maxStep;
+    if (step < -maxStep) step = -maxStep;
+    m_filterResonance += step;
+
+    StkFloat gain = m_filterTable.gain(m_filterCutoff);
+    StkFloat damping = m_filterTable.damping(m_filterCutoff, m_filterResonance);
+    for (int v = 0; v < m_numVoices; v++) {
+        MiVoice* voice = m_voices.at(v);
+        StkFloat octaves = m_filterKeyTrack * (voice->getKey() - 60) / 12.0
+                         + m_filterEnvAmount * voice->getEnvelope();
+        if (octaves == 0.0) {
+            m_filterBank.setCoefficients(v, gain, damping);
+            continue;
+        }
 
-    // Apply Reverb
-    switch (m_reverbType) {
-        case PRCREV:
-            revSamp = m_prcRev.tick(echoMixedSamp);
-            break;
-        case FREEREV:
-            revSamp = m_freeRev.tick(echoMixedSamp);
-            break;
-        case NREV:
-            revSamp = m_nRev.tick(echoMixedSamp);
-            break;
-        case JCREV:
-        default:
-            revSamp = m_jcRev.tick(echoMixedSamp);
-            break;
+        StkFloat position = m_filterTable.cutoffPosition(FILTER_CC_CUTOFF(m_filterCutoff) * StkMath::exp2(octaves));
+        m_filterBank.setCoefficients(v, m_filterTable.gain(position),
+                                     m_filterTable.damping(position, m_filterResonance));
     }
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::clearEchoes()
+// desc: empty the echo delay lines
+//-----------------------------------------------------------------------------
+void MiSynth::clearEchoes() {
+    m_echo1.clear();
+    m_echo2.clear();
+    m_echo3.clear();
+    m_echo4.clear();
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::clearReverbs()
+// desc: empty all of the reverbs
+//-----------------------------------------------------------------------------
+void MiSynth::clearReverbs() {
+    m_prcRev.clear();
+    m_jcRev.clear();
+    m_nRev.clear();
+    m_freeRev.clear();
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::publishEffects()
+// desc: work out the terms derived from the effects settings and hand them
+//       to the effects stage, which picks them up at its next block
+//-----------------------------------------------------------------------------
+void MiSynth::publishEffects() {
+    m_effects.echoGain34 = m_effects.echoFeedback * m_effects.echoFeedback;
+
+    m_effectExchange.back() = m_effects;
+    m_effectExchange.publish();
+}
+
+//-----------------------------------------------------------------------------
+// name: MiSynth::applyEffects()
+// desc: pick up the latest published effects settings, and push the ones
+//       that changed into the delays, reverbs and LFOs.  Runs on the thread
+//       running the effects, at the top of each block.
+//-----------------------------------------------------------------------------
+void MiSynth::applyEffects() {
+    if (!m_effectExchange.fetch()) return;
+    const MiEffectBlock& effects = m_effectExchange.front();
+    const MiEffectBlock& applied = m_appliedEffects;
 
-    // mix the reverb
-    revMixedSamp = m_reverbMix * revSamp + (1.0 - m_reverbMix) * echoMixedSamp;
+    if (effects.echoLength != applied.echoLength) {
+        unsigned long echoLength = effects.echoLength;
+        m_echoLength = echoLength;
 
-    // Tremelo!
-    tremeloSamp = revMixedSamp * (0.5 + 0.5 * m_LFOs.at(0)->tick());
+        // set the delays
+        m_echo1.setDelay(echoLength);
+        m_echo2.setDelay(echoLength * 2);
+        m_echo3.setDelay(echoLength * 3);
+        m_echo4.setDelay(echoLength * 4);
 
-    // Tremelo mix
-    returnSamp = m_tremeloMix * tremeloSamp + (1.0 - m_tremeloMix) * revMixedSamp;
+        // the third tap is fed from the first two, so its echo rings out last
+        m_echoSilence.setHold(echoLength * 5);
+    }
 
-    // return with the goods
-    return returnSamp;
+    // Also interesting to not clear them
+    m_reverbType = effects.reverbType;
+    if (effects.reverbClears != applied.reverbClears) clearReverbs();
+
+    if (effects.reverbSize != applied.reverbSize) {
+        // Reverb settings, the decays were worked out by setReverbSize()
+        m_prcRev.setCombCoefficients(effects.prcCombs);
+        m_jcRev.setCombCoefficients(effects.jcCombs);
+        m_nRev.setCombCoefficients(effects.nCombs);
+        m_freeRev.setEffectMix(1);
+        m_freeRev.setRoomSize(effects.roomSize);
+        m_freeRev.setDamping (0.5);
+    }
+
+    if (effects.echoMix != applied.echoMix) m_echoMix.setMix(effects.echoMix);
+    if (effects.reverbMix != applied.reverbMix) m_reverbMix.setMix(effects.reverbMix);
+    if (effects.tremeloMix != applied.tremeloMix) m_tremeloMix.setMix(effects.tremeloMix);
+
+    for (int i = 0; i < NUM_LFOS; i++) {
+        if (effects.lfoFrequency[i] != applied.lfoFrequency[i])
+            m_LFOs.at(i)->setFrequency(effects.lfoFrequency[i]);
+        if (effects.lfoWaveShape[i] != applied.lfoWaveShape[i])
+            m_LFOs.at(i)->setWaveShape(effects.lfoWaveShape[i]);
+        if (effects.lfoDepth[i] != applied.lfoDepth[i])
+            m_LFOs.at(i)->setVolume(effects.lfoDepth[i]);
+    }
+
+    m_appliedEffects = effects;
 }
 
 //-----------------------------------------------------------------------------
@@ -387,6 +1567,9 @@ StkFloat MiSynth::tick() {
 // desc: play a note
 //-----------------------------------------------------------------------------
 void MiSynth::noteOn(int note, int velocity) {
+    // keys the tuning leaves unmapped don't play
+    if (!m_tuning.isMapped(note)) return;
+
     // wrap around number of voices back to 0
     if (++m_voiceSelect >= m_numVoices) m_voiceSelect = 0;
 
@@ -427,8 +1610,15 @@ void MiSynth::noteOff(int note) {
 // desc: set attack, decay, susatain, and release at once
 //-----------------------------------------------------------------------------
 void MiSynth::setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R) {
-    for (int i = 0; i < m_numVoices; i++)
-        m_voices.at(i)->setADSR(A, D, S, R);
+    m_patch.setADSR(A, D, S, R);
+}
+
+//-----------------------------------------------------------------------------
+// name: setADSRCurve()
+// desc: set the envelope curve (ADSR::LINEAR or ADSR::EXPONENTIAL)
+//-----------------------------------------------------------------------------
+void MiSynth::setADSRCurve(int curve) {
+    m_patch.setADSRCurve(curve);
 }
 
 //-----------------------------------------------------------------------------
@@ -436,7 +1626,51 @@ void MiSynth::setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R) {
 // desc: set filter cutFreq and resonance
 //-----------------------------------------------------------------------------
 void MiSynth::setFilter(StkFloat cutFreq, StkFloat resonance) {
-    m_biquad.setResonance( cutFreq, resonance, true );
+    m_filterCutoffTarget = m_filterTable.cutoffPosition(cutFreq);
+    m_filterResonanceTarget = m_filterTable.resonancePosition(resonance);
+}
+
+//-----------------------------------------------------------------------------
+// name: setFilterCutoffCC()
+// desc: set the filter cutoff from a 7-bit controller (FILTER_CC_CUTOFF)
+//-----------------------------------------------------------------------------
+void MiSynth::setFilterCutoffCC(int cutoffCC) {
+    m_filterCutoffTarget = cutoffCC;
+}
+
+//-----------------------------------------------------------------------------
+// name: setFilterResonanceCC()
+// desc: set the filter resonance from a 7-bit controller (FILTER_CC_RADIUS)
+//-----------------------------------------------------------------------------
+void MiSynth::setFilterResonanceCC(int resonanceCC) {
+    m_filterResonanceTarget = resonanceCC;
+}
+
+//-----------------------------------------------------------------------------
+// name: setFilterType()
+// desc: set the filter response (SVFilter::LOWPASS, BANDPASS, HIGHPASS or
+//       NOTCH), bandpass by default
+//-----------------------------------------------------------------------------
+void MiSynth::setFilterType(int filterType) {
+    m_filterBank.setType(filterType);
+}
+
+//-----------------------------------------------------------------------------
+// name: setFilterKeyTrack()
+// desc: set how far the cutoff follows the note, in octaves per octave
+//       away from middle C (0 = off, 1 = follows the note exactly)
+//-----------------------------------------------------------------------------
+void MiSynth::setFilterKeyTrack(StkFloat keyTrack) {
+    m_filterKeyTrack = keyTrack;
+}
+
+//-----------------------------------------------------------------------------
+// name: setFilterEnvAmount()
+// desc: set how many octaves the voice envelope sweeps the cutoff by at
+//       full level (negative sweeps it down, 0 = off)
+//-----------------------------------------------------------------------------
+void MiSynth::setFilterEnvAmount(StkFloat envAmount) {
+    m_filterEnvAmount = envAmount;
 }
 
 //-----------------------------------------------------------------------------
@@ -444,9 +1678,7 @@ void MiSynth::setFilter(StkFloat cutFreq, StkFloat resonance) {
 // desc: set the wave shape for the oscilator
 //-----------------------------------------------------------------------------
 void MiSynth::setWaveShape(int oscNum, int waveShape) {
-    for (int i = 0; i < m_numVoices; i++) {
-        m_voices.at(i)->setWaveShape(oscNum, waveShape);
-    }
+    m_patch.setWaveShape(oscNum, waveShape);
 }
 
 //-----------------------------------------------------------------------------
@@ -454,9 +1686,7 @@ void MiSynth::setWaveShape(int oscNum, int waveShape) {
 // desc: set the volume of the oscilator
 //-----------------------------------------------------------------------------
 void MiSynth::setOscVolume(int oscNum, StkFloat volume) {
-    for (int i = 0; i < m_numVoices; i++) {
-        m_voices.at(i)->setOscVolume(oscNum, volume);
-    }
+    m_patch.setOscVolume(oscNum, volume);
 }
 
 //-----------------------------------------------------------------------------
@@ -464,7 +1694,7 @@ void MiSynth::setOscVolume(int oscNum, StkFloat volume) {
 // desc: set the level of the filter mix
 //-----------------------------------------------------------------------------
 void MiSynth::setFilterMix(StkFloat filterMix) {
-    m_filterMix = filterMix;
+    m_filterMix.setMix(filterMix);
 }
 
 //-----------------------------------------------------------------------------
@@ -472,7 +1702,8 @@ void MiSynth::setFilterMix(StkFloat filterMix) {
 // desc: set the level of the reverb mix
 //-----------------------------------------------------------------------------
 void MiSynth::setReverbMix(StkFloat reverbMix) {
-    m_reverbMix = reverbMix;
+    m_effects.reverbMix = reverbMix;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -480,13 +1711,11 @@ void MiSynth::setReverbMix(StkFloat reverbMix) {
 // desc: set the reverb type
 //-----------------------------------------------------------------------------
 void MiSynth::setReverbType(int reverbType) {
-    m_reverbType = reverbType;
+    m_effects.reverbType = reverbType;
 
-    // Also interesting to not clear them
-    m_prcRev.clear();
-    m_jcRev.clear();
-    m_nRev.clear();
-    m_freeRev.clear();
+    // the reverbs are cleared on every change, even to the same type
+    m_effects.reverbClears++;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -494,15 +1723,14 @@ void MiSynth::setReverbType(int reverbType) {
 // desc: set the reverb size
 //-----------------------------------------------------------------------------
 void MiSynth::setReverbSize(StkFloat reverbSize) {
-    m_reverbSize = reverbSize;
-
-    // Reverb settings
-    m_prcRev.setT60(reverbSize);
-    m_jcRev.setT60(reverbSize);
-    m_nRev.setT60(reverbSize);
-    m_freeRev.setEffectMix(1);
-    m_freeRev.setRoomSize(reverbSize / 7.11);
-    m_freeRev.setDamping (0.5);
+    m_effects.reverbSize = reverbSize;
+    m_effects.roomSize = reverbSize / 7.11;
+
+    // the decays cost a pow() per comb, so they're only worked out here
+    m_prcRev.getCombCoefficients(reverbSize, m_effects.prcCombs);
+    m_jcRev.getCombCoefficients(reverbSize, m_effects.jcCombs);
+    m_nRev.getCombCoefficients(reverbSize, m_effects.nCombs);
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -510,13 +1738,12 @@ void MiSynth::setReverbSize(StkFloat reverbSize) {
 // desc: set the length of the echo
 //-----------------------------------------------------------------------------
 void MiSynth::setEchoLength(unsigned long echoLength) {
-    m_echoLength = echoLength;
+    // each tap's delay line only holds its multiple of the longest echo
+    unsigned long maxLength = echoMaximumDelay(1, m_context->sampleRate());
+    if (echoLength > maxLength) echoLength = maxLength;
 
-    // set the delays
-    m_echo1.setDelay(echoLength);
-    m_echo2.setDelay(echoLength * 2);
-    m_echo3.setDelay(echoLength * 3);
-    m_echo4.setDelay(echoLength * 4);
+    m_effects.echoLength = echoLength;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -524,7 +1751,8 @@ void MiSynth::setEchoLength(unsigned long echoLength) {
 // desc: set the length of the echo
 //-----------------------------------------------------------------------------
 void MiSynth::setEchoFeedback(StkFloat echoFeedback) {
-    m_echoFeedback = echoFeedback;
+    m_effects.echoFeedback = echoFeedback;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -532,7 +1760,8 @@ void MiSynth::setEchoFeedback(StkFloat echoFeedback) {
 // desc: set the mix of the echo
 //-----------------------------------------------------------------------------
 void MiSynth::setEchoMix(StkFloat echoMix) {
-    m_echoMix = echoMix;
+    m_effects.echoMix = echoMix;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -540,9 +1769,7 @@ void MiSynth::setEchoMix(StkFloat echoMix) {
 // desc: set the tuning of the oscillator
 //-----------------------------------------------------------------------------
 void MiSynth::setOscTuning(int oscNum, double oscTuning) {
-    for (int i = 0; i < m_numVoices; i++) {
-        m_voices.at(i)->setOscTuning(oscNum, oscTuning);
-    }
+    m_patch.setOscTuning(oscNum, oscTuning);
 }
 
 //-----------------------------------------------------------------------------
@@ -550,7 +1777,10 @@ void MiSynth::setOscTuning(int oscNum, double oscTuning) {
 // desc: set the tuning of the Low Frequency Oscillator (LFO)
 //-----------------------------------------------------------------------------
 void MiSynth::setLFOFrequency(int lfoNum, double freq) {
-    m_LFOs.at(lfoNum)->setFrequency(freq);
+    if (lfoNum < 0 || lfoNum >= NUM_LFOS) return;
+
+    m_effects.lfoFrequency[lfoNum] = freq;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -558,9 +1788,10 @@ void MiSynth::setLFOFrequency(int lfoNum, double freq) {
 // desc: set the wave shape for the low frequency oscillators
 //-----------------------------------------------------------------------------
 void MiSynth::setLFOWaveShape(int oscNum, int waveShape) {
-    for (int i = 0; i < m_numLFOs; i++) {
-        m_LFOs.at(i)->setWaveShape(waveShape);
+    for (int i = 0; i < NUM_LFOS; i++) {
+        m_effects.lfoWaveShape[i] = waveShape;
     }
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -568,7 +1799,10 @@ void MiSynth::setLFOWaveShape(int oscNum, int waveShape) {
 // desc: set the depth of the lfo
 //-----------------------------------------------------------------------------
 void MiSynth::setLFODepth(int lfoNum,StkFloat lfoDepth) {
-    m_LFOs.at(lfoNum)->setVolume(lfoDepth);
+    if (lfoNum < 0 || lfoNum >= NUM_LFOS) return;
+
+    m_effects.lfoDepth[lfoNum] = lfoDepth;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -576,7 +1810,26 @@ void MiSynth::setLFODepth(int lfoNum,StkFloat lfoDepth) {
 // desc: set the mix of the echo
 //-----------------------------------------------------------------------------
 void MiSynth::setTremeloMix(StkFloat tremeloMix) {
-    m_tremeloMix = tremeloMix;
+    m_effects.tremeloMix = tremeloMix;
+    publishEffects();
+}
+
+//-----------------------------------------------------------------------------
+// name: setPanMix()
+// desc: set how much of the stereo pan the engine's pan stage mixes in
+//-----------------------------------------------------------------------------
+void MiSynth::setPanMix(StkFloat panMix) {
+    m_effects.panMix = panMix;
+    publishEffects();
+}
+
+//-----------------------------------------------------------------------------
+// name: setMasterVolume()
+// desc: set the volume the engine's pan stage scales the output by
+//-----------------------------------------------------------------------------
+void MiSynth::setMasterVolume(StkFloat masterVolume) {
+    m_effects.masterVolume = masterVolume;
+    publishEffects();
 }
 
 //-----------------------------------------------------------------------------
@@ -587,13 +1840,61 @@ StkFloat MiSynth::getStereoPan() {
     return m_LFOs.at(1)->tick();
 }
 
+//-----------------------------------------------------------------------------
+// name: getPanMix()
+// desc: get the pan mix as the effects stage last applied it, on the thread
+//       running the effects
+//-----------------------------------------------------------------------------
+StkFloat MiSynth::getPanMix() {
+    return m_appliedEffects.panMix;
+}
+
+//-----------------------------------------------------------------------------
+// name: getMasterVolume()
+// desc: get the master volume as the effects stage last applied it, on the
+//       thread running the effects
+//-----------------------------------------------------------------------------
+StkFloat MiSynth::getMasterVolume() {
+    return m_appliedEffects.masterVolume;
+}
+
 //-----------------------------------------------------------------------------
 // name: setNHarmonics()
 // desc: set the number of harmonics generated by BLIT algorithms (saw & square)
 //-----------------------------------------------------------------------------
 void MiSynth::setNHarmonics(int nHarmonics) {
-    for (int i = 0; i < m_numVoices; i++) {
-        m_voices.at(i)->setNHarmonics(nHarmonics);
-    }
+    m_patch.setNHarmonics(nHarmonics);
     m_nHarmonics = nHarmonics;
 }
+
+//-----------------------------------------------------------------------------
+// name: setPitchBend()
+// desc: bend every voice by a number of notes of the tuning, fractions
+//       glide between them
+//-----------------------------------------------------------------------------
+void MiSynth::setPitchBend(double pitchBend) {
+    m_patch.setPitchBend(pitchBend);
+}
+
+//-----------------------------------------------------------------------------
+// name: loadScale()
+// desc: retune to a Scala .scl scale (see MiTuning), false if it can't be
+//       loaded.  Call it while the synth isn't rendering.
+//-----------------------------------------------------------------------------
+bool MiSynth::loadScale(const std::string& path) {
+    if (!m_tuning.loadScale(path)) return false;
+    m_patch.setTuning(&m_tuning);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: loadKeyboardMap()
+// desc: map the scale onto the keys as a Scala .kbm keyboard map says (see
+//       MiTuning), false if it can't be loaded.  Call it while the synth
+//       isn't rendering.
+//-----------------------------------------------------------------------------
+bool MiSynth::loadKeyboardMap(const std::string& path) {
+    if (!m_tuning.loadKeyboardMap(path)) return false;
+    m_patch.setTuning(&m_tuning);
+    return true;
+}
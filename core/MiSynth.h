@@ -6,6 +6,10 @@
 #include "SineWave.h"
 #include "ADSR.h"
 #include "BiQuad.h"
+#include "SVFilter.h"
+#include "StkArena.h"
+#include "StkSimd.h"
+#include "StkMath.h"
 #include "BlitSaw.h"
 #include "BlitSquare.h"
 #include "Blit.h"
@@ -16,7 +20,10 @@
 #include "NRev.h"
 #include "Echo.h"
 #include "x-fun.h"
+#include "MiExchange.h"
+#include "MiTuning.h"
 #include <math.h>
+#include <limits>
 
 using namespace stk;
 
@@ -25,6 +32,15 @@ using namespace stk;
 #define SAW     1
 #define SQUARE  2
 #define PULSE   3
+// render kernel slot for an oscillator that contributes nothing (switched
+// off, or a shape tick() doesn't generate such as PULSE).  The kernel
+// table is indexed SINE, SAW, SQUARE, OSC_OFF.
+#define OSC_OFF 3
+#define NUM_KERNEL_SHAPES 4
+// most oscillators a voice can have
+#define MAX_OSCILLATORS 8
+// entries in the oscillators' shared sine table (plus a wrap-around guard point)
+#define OSC_SINE_TABLE_SIZE 2048
 
 // REVERB TYPES
 #define PRCREV    0
@@ -32,6 +48,194 @@ using namespace stk;
 #define NREV      2
 #define FREEREV   3
 
+// highest per-voice filter cutoff, as a fraction of the sample rate
+#define FILTER_CUTOFF_MAX (0.45)
+// cutoff (Hz) and pole radius the filter controllers map their 7-bit value to,
+// also used for fractional controller positions
+#define FILTER_CC_CUTOFF(cc) (20.0 + (cc) * 10000.0 / 128.0)
+#define FILTER_CC_RADIUS(cc) (((cc) + 1.0) / 130.0)
+// how fast the filter glides to a new cutoff or resonance (controller steps per second)
+#define FILTER_GLIDE_RATE (4000.0)
+
+// level (about -120 dB) below which a stage's input and tail count as silence
+#define SILENCE_THRESHOLD (1.0e-6)
+// how long the reverbs keep running after their input goes quiet (seconds),
+// longer than any of their internal delay lines
+#define REVERB_HOLD_TIME (0.25)
+// longest echo length (seconds), the echo taps sit at 1 to 4 times this
+#define ECHO_LENGTH_MAX (1.0)
+// low frequency oscillators, tremelo and stereo pan
+#define NUM_LFOS 2
+
+//-----------------------------------------------------------------------------
+// name: class MiStageSilence
+// desc: tracks when an effect stage has a silent input and a decayed tail,
+//       so the stage can be skipped until new input arrives
+//-----------------------------------------------------------------------------
+class MiStageSilence {
+public:
+    // constructor
+    MiStageSilence();
+
+public:
+    void setHold(unsigned long holdFrames);
+    bool wake(StkFloat inputPeak);
+    bool settle(StkFloat inputPeak, StkFloat outputPeak, unsigned int nFrames);
+    bool isSilent() const;
+
+private:
+    bool m_silent;
+    long m_hold;
+    long m_countdown;
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiStageMix
+// desc: wet/dry mix of an effect stage.  Mix changes are ramped across a
+//       block so they don't click, and the stage only stays in the plan
+//       while its mix (or a ramp down to zero) can be heard.
+//-----------------------------------------------------------------------------
+class MiStageMix {
+public:
+    // constructor
+    MiStageMix(StkFloat mix = 0.0);
+
+public:
+    void setMix(StkFloat mix);
+    bool begin(unsigned int nFrames);
+    bool end();
+    bool isActive() const;
+    StkFloat start() const;
+    StkFloat step() const;
+
+private:
+    StkFloat m_mix;
+    StkFloat m_current;
+    StkFloat m_start;
+    StkFloat m_step;
+    bool m_active;
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiFilterTable
+// desc: filter coefficient terms precomputed for every cutoff and resonance
+//       controller value, looked up with linear interpolation at fractional
+//       positions so nothing transcendental runs when a knob moves
+//-----------------------------------------------------------------------------
+class MiFilterTable {
+public:
+    // constructor
+    MiFilterTable();
+
+public:
+    void build();
+    StkFloat cutoffPosition(StkFloat cutoff) const;
+    StkFloat resonancePosition(StkFloat radius) const;
+    StkFloat gain(StkFloat cutoffPosition) const;
+    StkFloat damping(StkFloat cutoffPosition, StkFloat resonancePosition) const;
+
+private:
+    StkContext* m_context;
+    StkFloat m_maxPosition;
+    std::vector<StkFloat> m_gain;
+    std::vector<StkFloat> m_bandwidth;
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiFilterBank
+// desc: one state-variable filter (see SVFilter) per voice.  The coefficients
+//       and state of all the voices sit in separate arrays, one lane per
+//       voice, so a block is filtered across every voice at once.
+//-----------------------------------------------------------------------------
+class MiFilterBank {
+public:
+    // constructor
+    MiFilterBank(int numLanes = 8);
+
+public:
+    void setType(int type);
+    void setCoefficients(int lane, StkFloat gain, StkFloat damping);
+    void clear();
+    StkFrames& tick(StkFrames& frames);
+
+private:
+    void setMix(int lane);
+
+    int m_numLanes;
+    int m_type;
+    std::vector<StkFloat> m_g;
+    std::vector<StkFloat> m_k;
+    std::vector<StkFloat> m_a1;
+    std::vector<StkFloat> m_a2;
+    std::vector<StkFloat> m_a3;
+    std::vector<StkFloat> m_m0;
+    std::vector<StkFloat> m_m1;
+    std::vector<StkFloat> m_m2;
+    std::vector<StkFloat> m_ic1;
+    std::vector<StkFloat> m_ic2;
+};
+
+//-----------------------------------------------------------------------------
+// name: class MiPatch
+// desc: the sound every voice of a synth shares (envelope, oscillator
+//       shapes, volumes, tunings, harmonics, note tables and pitch bend),
+//       held once per synth along with the envelope rates derived from it.
+//       A change is one write here and a bump of the version; each voice
+//       catches up with the version the next time it plays or renders, so
+//       the cost of a change doesn't grow with the number of voices and
+//       idle voices pay nothing.
+//-----------------------------------------------------------------------------
+class MiPatch {
+public:
+    // constructor
+    MiPatch();
+
+public:
+    void setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R);
+    void setADSRCurve(int curve);
+    void setWaveShape(int oscNum, int waveShape);
+    void setOscVolume(int oscNum, StkFloat volume);
+    void setOscTuning(int oscNum, double oscTuning);
+    void setNHarmonics(int nHarmonics);
+    void setTuning(const MiTuning* tuning);
+    void setPitchBend(double pitchBend);
+    void applyEnvelope(ADSR& adsr) const;
+    unsigned long getVersion() const;
+    unsigned long getEnvelopeVersion() const;
+    unsigned long getTuningVersion() const;
+    int getADSRCurve() const;
+    int getWaveShape(int oscNum) const;
+    StkFloat getOscVolume(int oscNum) const;
+    double getOscTuning(int oscNum) const;
+    int getNHarmonics() const;
+    double getIncrement(int note) const;
+
+private:
+    StkContext* m_context;
+    unsigned long m_version;
+    unsigned long m_envelopeVersion;
+    unsigned long m_tuningVersion;
+
+    // envelope times, and the rates per sample ADSR runs on
+    StkFloat m_A;
+    StkFloat m_D;
+    StkFloat m_S;
+    StkFloat m_R;
+    StkFloat m_attackRate;
+    StkFloat m_decayRate;
+    StkFloat m_releaseRate;
+    int m_adsrCurve;
+
+    int m_waveShape[MAX_OSCILLATORS];
+    StkFloat m_oscVolume[MAX_OSCILLATORS];
+    double m_oscTuning[MAX_OSCILLATORS];
+    int m_nHarmonics;
+
+    // the note tables, and the pitch bend in notes of them
+    const MiTuning* m_tuning;
+    double m_pitchBend;
+};
+
 //-----------------------------------------------------------------------------
 // name: class MiOsc
 // desc: feedback echo effect
@@ -41,28 +245,142 @@ public:
     // constructor
     MiOsc();
     // destructor
-    virtual ~MiOsc();
+    ~MiOsc();
 
 public:
     StkFloat tick();
+    template <int SHAPE> StkFloat tickShape();
     void setWaveShape(int waveShape);
     void setVolume(StkFloat volume);
     void setFrequency(double freq);
+    void setIncrement(double increment);
     void setTuning(StkFloat oscTuning);
     void setNHarmonics(int nHarmonics);
+    bool isAudible();
+    int getKernelShape();
+    int getWaveShape();
+    StkFloat getVolume();
+    double getTuning();
+
+private:
+    void updateHarmonics();
+    void advancePhase();
+    StkFloat sawSample();
+    StkFloat squareSample();
+    StkFloat sineSample();
+    static bool fillSineTable();
 
 private:
+    StkContext* m_context;
     int m_waveShape;
     int m_nHarmonics;
     StkFloat m_oscVolume;
     double m_tune;
-    double m_freq;
+    // phase increment before the tuning, in cycles per sample
+    double m_increment;
 
-    BlitSaw m_blitSaw;
-    BlitSquare m_blitSquare;
-    SineWave m_sine;
+    // one phase for every shape, in cycles [0, 1)
+    double m_phase;
+    double m_rate;
+    // period in samples and the BLIT parameters derived from it
+    StkFloat m_period;
+    unsigned int m_sawM;
+    StkFloat m_sawA;
+    unsigned int m_squareM;
+    StkFloat m_squareA;
+    // saw leaky integrator, square integrator and DC blocker
+    StkFloat m_sawState;
+    StkFloat m_squareBlit;
+    StkFloat m_squareDcb;
+    StkFloat m_squareOut;
+
+    static StkFloat s_sineTable[OSC_SINE_TABLE_SIZE + 1];
 };
 
+//-----------------------------------------------------------------------------
+// name: MiOsc::advancePhase()
+// desc: move the shared phase on by one sample
+//-----------------------------------------------------------------------------
+inline void MiOsc::advancePhase() {
+    m_phase += m_rate;
+    if (m_phase >= 1.0) m_phase -= 1.0;
+}
+
+//-----------------------------------------------------------------------------
+// name: MiOsc::sawSample()
+// desc: BLIT sawtooth (Stilson & Smith, as in BlitSaw), the BLIT runs at
+//       PI * phase and is summed by a leaky integrator
+//-----------------------------------------------------------------------------
+inline StkFloat MiOsc::sawSample() {
+    StkFloat phase = PI * m_phase;
+    StkFloat tmp, denominator = StkMath::sin(phase);
+    if (fabs(denominator) <= std::numeric_limits<StkFloat>::epsilon())
+        tmp = m_sawA;
+    else
+        tmp = StkMath::sin(m_sawM * phase) / (m_period * denominator);
+
+    tmp += m_sawState - m_rate;
+    m_sawState = Stk::undenormalize(tmp * 0.995);
+    return tmp;
+}
+
+//-----------------------------------------------------------------------------
+// name: MiOsc::squareSample()
+// desc: BLIT square (as in BlitSquare), a bipolar BLIT at TWO_PI * phase
+//       summed and passed through a DC blocker
+//-----------------------------------------------------------------------------
+inline StkFloat MiOsc::squareSample() {
+    StkFloat phase = TWO_PI * m_phase;
+    StkFloat blit, denominator = StkMath::sin(phase);
+    if (fabs(denominator) < std::numeric_limits<StkFloat>::epsilon())
+        blit = (phase < 0.1 || phase > TWO_PI - 0.1) ? m_squareA : -m_squareA;
+    else
+        blit = StkMath::sin(m_squareM * phase) / (0.5 * m_period * denominator);
+
+    blit += m_squareBlit;
+    m_squareOut = Stk::undenormalize(blit - m_squareDcb + 0.999 * m_squareOut);
+    m_squareDcb = blit;
+    m_squareBlit = blit;
+    return m_squareOut;
+}
+
+//-----------------------------------------------------------------------------
+// name: MiOsc::sineSample()
+// desc: sine by linear interpolation in the shared table
+//-----------------------------------------------------------------------------
+inline StkFloat MiOsc::sineSample() {
+    StkFloat index = m_phase * OSC_SINE_TABLE_SIZE;
+    unsigned int i = (unsigned int) index;
+    StkFloat alpha = index - i;
+    return s_sineTable[i] + alpha * (s_sineTable[i + 1] - s_sineTable[i]);
+}
+
+//-----------------------------------------------------------------------------
+// name: MiOsc::tickShape()
+// desc: generate a sample of output with the wave shape fixed at compile
+//       time, OSC_OFF generates nothing and ticks nothing
+//-----------------------------------------------------------------------------
+template <int SHAPE>
+inline StkFloat MiOsc::tickShape() {
+    StkFloat sample;
+    switch (SHAPE) {
+      case SINE:
+        sample = sineSample();
+        break;
+      case SAW:
+        sample = sawSample();
+        break;
+      case SQUARE:
+        sample = squareSample();
+        break;
+      default:
+        return 0;
+    }
+
+    advancePhase();
+    return sample * m_oscVolume;
+}
+
 //-----------------------------------------------------------------------------
 // name: class MiVoice
 // desc: feedback echo effect
@@ -72,34 +390,91 @@ public:
     // constructor
     MiVoice( int numOscillators = 3, double freqRangeLow = 20, double freqRangeHigh = 20000 );
     // destructor
-    virtual ~MiVoice();
+    ~MiVoice();
 
 public:
     StkFloat tick();
+    void renderBlock(StkFrames& frames, unsigned int nFrames, unsigned int channel = 0);
     void setFreqRange( double freqRangeLow, double freqRangeHigh );
+    void setPatch(const MiPatch* patch);
     void playNote(int note, int velocity = 127);
     void stopNote();
-    void setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R);
-    void setWaveShape(int oscNum, int waveShape);
-    void setOscVolume(int oscNum, StkFloat volume);
-    void setOscTuning(int oscNum, double oscTuning);
-    void setNHarmonics(int nHarmonics);
     int getNote();
+    int getKey();
+    StkFloat getEnvelope();
+    bool isActive();
 
 private:
+    // renders nFrames into samples (hop apart), scaled by the envelope
+    typedef void (*Kernel)(MiVoice* voice, const StkFloat* envelope, StkFloat* samples,
+                           unsigned int hop, unsigned int nFrames);
+    template <int S0, int S1, int S2>
+    static void renderKernel(MiVoice* voice, const StkFloat* envelope, StkFloat* samples,
+                             unsigned int hop, unsigned int nFrames);
+    static void renderPlanned(MiVoice* voice, const StkFloat* envelope, StkFloat* samples,
+                              unsigned int hop, unsigned int nFrames);
+    static const Kernel s_kernels[NUM_KERNEL_SHAPES][NUM_KERNEL_SHAPES][NUM_KERNEL_SHAPES];
+
+    void updatePlan();
+    void updatePatch();
+    void retune();
+
     int m_note;
+    int m_key;
     bool m_playing;
     int m_numOscillators;
     int m_nHarmonics;
     std::vector<MiOsc*> m_oscillators;
+    std::vector<int> m_oscPlan;
+    int m_numPlanned;
+    Kernel m_kernel;
     double m_freqRangeLow;
     double m_freqRangeHigh;
 
-    StkFloat m_A;
-    StkFloat m_D;
-    StkFloat m_S;
-    StkFloat m_R;
+    // the synth's patch, and the versions of it this voice has caught up with
+    const MiPatch* m_patch;
+    unsigned long m_patchVersion;
+    unsigned long m_envelopeVersion;
+    unsigned long m_tuningVersion;
     ADSR m_adsr;
+    StkFrames m_envelope;
+};
+
+//-----------------------------------------------------------------------------
+// name: struct MiEffectBlock
+// desc: the effects stage's settings as the knobs left them, plus the terms
+//       its loops need worked out from them, so the loops only multiply and
+//       add.  MiSynth compiles a new block whenever a setting changes and
+//       hands it to the thread running the effects through a MiExchange.
+//-----------------------------------------------------------------------------
+struct MiEffectBlock {
+    // echo, with the gain of taps 3 + 4 derived from the feedback
+    unsigned long echoLength;
+    StkFloat echoMix;
+    StkFloat echoFeedback;
+    StkFloat echoGain34;
+
+    // reverb.  Every setReverbType() clears the reverbs, even to the same
+    // type, so the calls are counted.  The room size and comb coefficients
+    // are worked out from the size, which is below zero until it's set.
+    int reverbType;
+    unsigned long reverbClears;
+    StkFloat reverbSize;
+    StkFloat roomSize;
+    StkFloat prcCombs[PRCRev::nCombs];
+    StkFloat jcCombs[JCRev::nCombs];
+    StkFloat nCombs[NRev::nCombs];
+    StkFloat reverbMix;
+
+    // tremelo and the LFOs
+    StkFloat tremeloMix;
+    double lfoFrequency[NUM_LFOS];
+    int lfoWaveShape[NUM_LFOS];
+    StkFloat lfoDepth[NUM_LFOS];
+
+    // the pan stage MiEngine runs after the effects, on the same thread
+    StkFloat panMix;
+    StkFloat masterVolume;
 };
 
 //-----------------------------------------------------------------------------
@@ -114,11 +489,18 @@ public:
     virtual ~MiSynth();
 
 public:
-    StkFloat tick();
+    static size_t arenaSize(int numVoices, StkFloat sampleRate);
+    StkFrames& tick(StkFrames& frames);
     void noteOn(int note, int velocity);
     void noteOff(int note);
     void setADSR(StkFloat A, StkFloat D, StkFloat S, StkFloat R);
+    void setADSRCurve(int curve);
     void setFilter(StkFloat cutFreq, StkFloat resonance);
+    void setFilterCutoffCC(int cutoffCC);
+    void setFilterResonanceCC(int resonanceCC);
+    void setFilterType(int filterType);
+    void setFilterKeyTrack(StkFloat keyTrack);
+    void setFilterEnvAmount(StkFloat envAmount);
     void setWaveShape(int oscNum, int waveShape);
     void setOscVolume(int oscNum, StkFloat oscVolume);
     void setOscTuning(int oscNum, double oscTuning);
@@ -133,10 +515,28 @@ public:
     void setLFOWaveShape(int lfoNum, int waveShape);
     void setLFODepth(int lfoNum, StkFloat depth);
     void setTremeloMix(StkFloat tremeloMix);
+    void setPanMix(StkFloat panMix);
+    void setMasterVolume(StkFloat masterVolume);
     void setNHarmonics(int nHarmonics);
+    void setPitchBend(double pitchBend);
+    bool loadScale(const std::string& path);
+    bool loadKeyboardMap(const std::string& path);
     StkFloat getStereoPan();
+    StkFloat getPanMix();
+    StkFloat getMasterVolume();
+    StkFloat renderVoices(StkFrames& monoFrames);
+    void renderEffects(StkFrames& monoFrames, StkFloat inputPeak, StkFrames& frames);
 
 private:
+    void renderBlock(StkFrames& frames);
+    void updateFilters(unsigned int nFrames);
+    void publishEffects();
+    void applyEffects();
+    void clearEchoes();
+    void clearReverbs();
+
+    StkContext* m_context;
+    unsigned int m_blockSize;
     int m_numVoices;
     int m_numLFOs;
     std::vector<MiVoice*> m_voices;
@@ -144,24 +544,45 @@ private:
     bool m_muted;
     double m_volume;
     int m_voiceSelect;
-    BiQuad m_biquad;
-    StkFloat m_filterMix;
-    StkFloat m_reverbMix;
+    MiPatch m_patch;
+    MiTuning m_tuning;
+    MiFilterBank m_filterBank;
+    MiFilterTable m_filterTable;
+    StkFrames m_voiceBuffer;
+    StkFloat m_filterCutoff;
+    StkFloat m_filterResonance;
+    StkFloat m_filterCutoffTarget;
+    StkFloat m_filterResonanceTarget;
+    StkFloat m_filterKeyTrack;
+    StkFloat m_filterEnvAmount;
+    MiStageMix m_filterMix;
+    MiStageMix m_reverbMix;
     PRCRev m_prcRev;
     NRev m_nRev;
     JCRev m_jcRev;
     FreeVerb m_freeRev;
     int m_reverbType;
     int m_nHarmonics;
-    StkFloat m_reverbSize;
     Echo m_echo1;
     Echo m_echo2;
     Echo m_echo3;
     Echo m_echo4;
     unsigned long m_echoLength;
-    StkFloat m_echoMix;
-    StkFloat m_echoFeedback;
-    StkFloat m_tremeloMix;
+    MiStageMix m_echoMix;
+    MiStageMix m_tremeloMix;
+
+    // effects settings as set, and as the effects stage last applied them
+    MiEffectBlock m_effects;
+    MiExchange<MiEffectBlock> m_effectExchange;
+    MiEffectBlock m_appliedEffects;
+    StkFrames m_monoBuffer;
+    StkFrames m_filterBuffer;
+    StkFrames m_wetBuffer;
+    StkFrames m_leftBuffer;
+    StkFrames m_rightBuffer;
+    MiStageSilence m_filterSilence;
+    MiStageSilence m_echoSilence;
+    MiStageSilence m_reverbSilence;
 };
 
 #endif
@@ -0,0 +1,274 @@
+// MiTuning.cpp
+#include "MiTuning.h"
+#include "x-fun.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+
+using namespace stk;
+
+//-----------------------------------------------------------------------------
+// name: floorDivide()
+// desc: a / b rounded down, so notes below the tonic land in the pattern
+//       below it
+//-----------------------------------------------------------------------------
+static int floorDivide(int a, int b) {
+    int quotient = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) quotient--;
+    return quotient;
+}
+
+//-----------------------------------------------------------------------------
+// name: readLine()
+// desc: the next line of a Scala file that isn't a comment (starting with
+//       !), and blank lines too unless they're wanted.  Returns false at the
+//       end of the file.
+//-----------------------------------------------------------------------------
+static bool readLine(std::istream& file, std::string& line, int& lineNumber, bool blank = false) {
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        if (!line.empty() && line[0] == '!') continue;
+        if (!blank && line.find_first_not_of(" \t") == std::string::npos) continue;
+        return true;
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// name: readPitch()
+// desc: log2 of a scale line's pitch, cents if it has a decimal point and a
+//       ratio (or a whole number) if not, anything after it is ignored
+//-----------------------------------------------------------------------------
+static bool readPitch(const std::string& line, double& pitch) {
+    std::istringstream fields(line);
+    std::string value;
+    if (!(fields >> value)) return false;
+
+    std::istringstream number(value);
+    if (value.find('.') != std::string::npos) {
+        double cents;
+        if (!(number >> cents)) return false;
+        pitch = cents / 1200.0;
+        return true;
+    }
+
+    long numerator;
+    long denominator = 1;
+    char slash;
+    if (!(number >> numerator)) return false;
+    if (number >> slash) {
+        if (slash != '/' || !(number >> denominator)) return false;
+    }
+    if (numerator <= 0 || denominator <= 0) return false;
+    pitch = log2((double) numerator / denominator);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: MiTuning()
+// desc: constructor, equal temperament at the current context's sample rate
+//-----------------------------------------------------------------------------
+MiTuning::MiTuning() {
+    m_context = StkContext::current();
+    setEqualTemperament();
+}
+
+//-----------------------------------------------------------------------------
+// name: setEqualTemperament()
+// desc: twelve tone equal temperament from note 57 at 440 Hz, the tables
+//       are XFun::midi2freq() exactly.  Loading a keyboard map after this
+//       maps it onto the twelve tone scale.
+//-----------------------------------------------------------------------------
+void MiTuning::setEqualTemperament() {
+    m_degrees.clear();
+    for (int i = 1; i <= 12; i++) m_degrees.push_back(i / 12.0);
+
+    m_keyMap.clear();
+    m_firstNote = 0;
+    m_lastNote = TUNING_NOTES - 1;
+    m_middleNote = TUNING_MIDDLE_NOTE;
+    m_referenceNote = TUNING_REFERENCE_NOTE;
+    m_referenceFrequency = TUNING_REFERENCE_FREQUENCY;
+    m_octaveDegree = 0;
+
+    for (int note = 0; note < TUNING_NOTES; note++) {
+        m_mapped[note] = true;
+        m_frequency[note] = XFun::midi2freq(note);
+        m_increment[note] = m_frequency[note] / m_context->sampleRate();
+        m_pitch[note] = log2(m_frequency[note]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: loadScale()
+// desc: retune to the scale in a Scala .scl file, played through the
+//       current keyboard map.  Returns false, keeping the current tuning, if
+//       the file can't be read or is bad (which is reported).
+//-----------------------------------------------------------------------------
+bool MiTuning::loadScale(const std::string& path) {
+    std::ifstream file(path.c_str());
+    if (!file) return false;
+
+    // build the new tables on the side so a bad file changes nothing
+    MiTuning* loaded = new MiTuning(*this);
+    loaded->m_degrees.clear();
+
+    // a description (which can be blank), the number of degrees, then
+    // one line per degree
+    std::string line;
+    int lineNumber = 0;
+    int numDegrees = 0;
+    bool good = readLine(file, line, lineNumber, true)
+             && readLine(file, line, lineNumber)
+             && (std::istringstream(line) >> numDegrees) && numDegrees > 0;
+    for (int i = 0; good && i < numDegrees; i++) {
+        double pitch;
+        good = readLine(file, line, lineNumber) && readPitch(line, pitch);
+        if (good) loaded->m_degrees.push_back(pitch);
+    }
+
+    if (!good) {
+        std::cerr << "MiTuning: bad scale on line " << lineNumber
+                  << " of " << path << ", keeping the current tuning\n";
+    }
+    else if ((good = loaded->update(path))) {
+        *this = *loaded;
+    }
+    delete loaded;
+    return good;
+}
+
+//-----------------------------------------------------------------------------
+// name: loadKeyboardMap()
+// desc: map the current scale onto the keys as a Scala .kbm file says.
+//       Returns false, keeping the current tuning, if the file can't be read
+//       or is bad (which is reported).
+//-----------------------------------------------------------------------------
+bool MiTuning::loadKeyboardMap(const std::string& path) {
+    std::ifstream file(path.c_str());
+    if (!file) return false;
+
+    MiTuning* loaded = new MiTuning(*this);
+    loaded->m_keyMap.clear();
+
+    // the pattern size, first and last notes to retune, the note the
+    // tonic sits on, the reference note and its frequency, and the degree
+    // a whole pattern spans (0 for the scale's period)
+    std::string line;
+    int lineNumber = 0;
+    int mapSize = 0;
+    bool good = readLine(file, line, lineNumber) && (std::istringstream(line) >> mapSize) && mapSize >= 0
+             && readLine(file, line, lineNumber) && (std::istringstream(line) >> loaded->m_firstNote)
+             && readLine(file, line, lineNumber) && (std::istringstream(line) >> loaded->m_lastNote)
+             && readLine(file, line, lineNumber) && (std::istringstream(line) >> loaded->m_middleNote)
+             && readLine(file, line, lineNumber) && (std::istringstream(line) >> loaded->m_referenceNote)
+             && readLine(file, line, lineNumber) && (std::istringstream(line) >> loaded->m_referenceFrequency)
+             && readLine(file, line, lineNumber) && (std::istringstream(line) >> loaded->m_octaveDegree);
+    good = good && loaded->m_firstNote >= 0 && loaded->m_firstNote <= loaded->m_lastNote
+                && loaded->m_lastNote < TUNING_NOTES
+                && loaded->m_middleNote >= 0 && loaded->m_middleNote < TUNING_NOTES
+                && loaded->m_referenceNote >= 0 && loaded->m_referenceNote < TUNING_NOTES
+                && loaded->m_referenceFrequency > 0.0 && loaded->m_octaveDegree >= 0;
+
+    // the degree each key of the pattern plays, x for none.  Keys past the
+    // end of the file are unmapped.
+    for (int i = 0; good && i < mapSize; i++) {
+        int degree = -1;
+        std::string value;
+        if (readLine(file, line, lineNumber) && (std::istringstream(line) >> value) && value != "x") {
+            good = (std::istringstream(value) >> degree) && degree >= 0;
+        }
+        loaded->m_keyMap.push_back(degree);
+    }
+
+    if (!good) {
+        std::cerr << "MiTuning: bad keyboard map on line " << lineNumber
+                  << " of " << path << ", keeping the current tuning\n";
+    }
+    else if ((good = loaded->update(path))) {
+        *this = *loaded;
+    }
+    delete loaded;
+    return good;
+}
+
+//-----------------------------------------------------------------------------
+// name: update()
+// desc: rebuild the tables from the scale and keyboard map, notes outside
+//       the map's range stay in equal temperament.  Returns false (and says
+//       so, naming the file loaded) if the reference note or every key is
+//       unmapped, leaving the tables half built.
+//-----------------------------------------------------------------------------
+bool MiTuning::update(const std::string& path) {
+    double referencePitch;
+    if (!getPitch(m_referenceNote, referencePitch)) {
+        std::cerr << "MiTuning: the reference note isn't mapped after loading "
+                  << path << ", keeping the current tuning\n";
+        return false;
+    }
+
+    for (int note = 0; note < TUNING_NOTES; note++) {
+        double pitch;
+        m_mapped[note] = true;
+        if (note < m_firstNote || note > m_lastNote)
+            m_frequency[note] = XFun::midi2freq(note);
+        else if (getPitch(note, pitch))
+            m_frequency[note] = m_referenceFrequency * pow(2.0, pitch - referencePitch);
+        else
+            m_mapped[note] = false;
+    }
+
+    // unmapped keys don't play, but bends across them need a pitch, so
+    // they take the pitch of the mapped key below (or above, at the bottom)
+    int nearest = 0;
+    while (nearest < TUNING_NOTES && !m_mapped[nearest]) nearest++;
+    if (nearest == TUNING_NOTES) {
+        std::cerr << "MiTuning: no key is mapped after loading "
+                  << path << ", keeping the current tuning\n";
+        return false;
+    }
+    for (int note = 0; note < TUNING_NOTES; note++) {
+        if (m_mapped[note]) nearest = note;
+        else m_frequency[note] = m_frequency[nearest];
+
+        m_increment[note] = m_frequency[note] / m_context->sampleRate();
+        m_pitch[note] = log2(m_frequency[note]);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: getPitch()
+// desc: log2 of a note's ratio above the tonic, through the keyboard map,
+//       false for an unmapped key
+//-----------------------------------------------------------------------------
+bool MiTuning::getPitch(int note, double& pitch) const {
+    int distance = note - m_middleNote;
+    if (m_keyMap.empty()) {
+        pitch = getDegreePitch(distance);
+        return true;
+    }
+
+    int mapSize = (int) m_keyMap.size();
+    int pattern = floorDivide(distance, mapSize);
+    int degree = m_keyMap[distance - pattern * mapSize];
+    if (degree < 0) return false;
+
+    int octaveDegree = m_octaveDegree > 0 ? m_octaveDegree : (int) m_degrees.size();
+    pitch = pattern * getDegreePitch(octaveDegree) + getDegreePitch(degree);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: getDegreePitch()
+// desc: log2 of a scale degree's ratio above the tonic, degrees past the
+//       end (or below the tonic) repeat the scale a period up (or down)
+//-----------------------------------------------------------------------------
+double MiTuning::getDegreePitch(int degree) const {
+    int numDegrees = (int) m_degrees.size();
+    int period = floorDivide(degree, numDegrees);
+    int step = degree - period * numDegrees;
+    return period * m_degrees[numDegrees - 1] + (step > 0 ? m_degrees[step - 1] : 0.0);
+}
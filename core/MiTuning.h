@@ -0,0 +1,131 @@
+#ifndef MI_TUNING_H
+#define MI_TUNING_H
+
+#include "Stk.h"
+#include "StkMath.h"
+#include <string>
+#include <vector>
+
+using namespace stk;
+
+// MIDI note numbers
+#define TUNING_NOTES 128
+
+// the synth's concert pitch, note 57 is A 440 (as in XFun::midi2freq)
+#define TUNING_REFERENCE_NOTE 57
+#define TUNING_REFERENCE_FREQUENCY (440.0)
+#define TUNING_MIDDLE_NOTE 48
+
+//-----------------------------------------------------------------------------
+// name: class MiTuning
+// desc: the frequency, and the oscillator phase increment at the current
+//       context's sample rate, of every MIDI note, in tables built once so
+//       playing a note is a lookup.  Starts out in equal temperament;
+//       loadScale() and loadKeyboardMap() retune it from Scala files
+//
+//           .scl  the scale's degrees above the tonic, in cents (with a
+//                 decimal point) or ratios, the last being the period
+//           .kbm  which notes are retuned, the note the tonic sits on,
+//                 the reference note and its frequency, and which degree
+//                 each key of a repeating pattern plays (x for none)
+//
+//       Keys a keyboard map leaves unmapped don't play.  Fractional notes,
+//       for pitch bends, glide in pitch between neighbouring notes of the
+//       tuning.
+//-----------------------------------------------------------------------------
+class MiTuning {
+public:
+    // constructor
+    MiTuning();
+
+public:
+    bool loadScale(const std::string& path);
+    bool loadKeyboardMap(const std::string& path);
+    void setEqualTemperament();
+    bool isMapped(int note) const;
+    double getFrequency(int note) const;
+    double getFrequency(double note) const;
+    double getIncrement(int note) const;
+    double getIncrement(double note) const;
+
+private:
+    bool update(const std::string& path);
+    bool getPitch(int note, double& pitch) const;
+    double getDegreePitch(int degree) const;
+
+    StkContext* m_context;
+
+    // the scale, log2 of each degree above the tonic up to the period
+    std::vector<double> m_degrees;
+
+    // the keyboard map, the degree each key of the pattern plays (-1 for
+    // none), an empty pattern plays one degree per key
+    std::vector<int> m_keyMap;
+    int m_firstNote;
+    int m_lastNote;
+    int m_middleNote;
+    int m_referenceNote;
+    double m_referenceFrequency;
+    int m_octaveDegree;
+
+    // the tables, and log2 of each frequency to bend between them
+    bool m_mapped[TUNING_NOTES];
+    double m_frequency[TUNING_NOTES];
+    double m_increment[TUNING_NOTES];
+    double m_pitch[TUNING_NOTES];
+};
+
+//-----------------------------------------------------------------------------
+// name: MiTuning::isMapped()
+// desc: false for notes outside MIDI and keys the keyboard map leaves out
+//-----------------------------------------------------------------------------
+inline bool MiTuning::isMapped(int note) const {
+    return note >= 0 && note < TUNING_NOTES && m_mapped[note];
+}
+
+//-----------------------------------------------------------------------------
+// name: MiTuning::getFrequency()
+// desc: frequency of a note in Hz, clamped to MIDI
+//-----------------------------------------------------------------------------
+inline double MiTuning::getFrequency(int note) const {
+    if (note < 0) note = 0;
+    if (note >= TUNING_NOTES) note = TUNING_NOTES - 1;
+    return m_frequency[note];
+}
+
+//-----------------------------------------------------------------------------
+// name: MiTuning::getFrequency()
+// desc: frequency of a fractional note, whole notes are straight from the
+//       table and the ones between are a fraction of the way in pitch
+//-----------------------------------------------------------------------------
+inline double MiTuning::getFrequency(double note) const {
+    if (note <= 0.0) return m_frequency[0];
+    if (note >= TUNING_NOTES - 1) return m_frequency[TUNING_NOTES - 1];
+
+    int index = (int) note;
+    double alpha = note - index;
+    if (alpha == 0.0) return m_frequency[index];
+    return StkMath::exp2(m_pitch[index] + alpha * (m_pitch[index + 1] - m_pitch[index]));
+}
+
+//-----------------------------------------------------------------------------
+// name: MiTuning::getIncrement()
+// desc: phase increment of a note, in cycles per sample
+//-----------------------------------------------------------------------------
+inline double MiTuning::getIncrement(int note) const {
+    if (note < 0) note = 0;
+    if (note >= TUNING_NOTES) note = TUNING_NOTES - 1;
+    return m_increment[note];
+}
+
+//-----------------------------------------------------------------------------
+// name: MiTuning::getIncrement()
+// desc: phase increment of a fractional note
+//-----------------------------------------------------------------------------
+inline double MiTuning::getIncrement(double note) const {
+    int index = (int) note;
+    if (index == note) return getIncrement(index);
+    return getFrequency(note) / m_context->sampleRate();
+}
+
+#endif
@@ -10,7 +10,7 @@
   Distributed as-is; no warranty is given.
 */
 
-#include "MiSynth.h"
+#include "MiEngine.h"
 #include "RtAudio.h"
 #include "RtMidi.h"
 #include "SineWave.h"
@@ -39,29 +39,29 @@ using namespace stk;
 #define DEFAULT_SAMPLE_RATE (44100.0)
 #define NUM_CHANNELS 2
 #define NUM_DEFALUT_VOICES 8
-#define DEFAULT_VOLUME (0.9)
-#define NOTE_ON 144
-#define NOTE_OFF 128
-#define CONTROL_CHANGE 176
-#define KNOBULE_LAYOUT 0
-#define AKAIMPK_LAYOUT 1
-#define LFO_SPEED_MAX (13.0)
+#define NUM_DEFAULT_PARTS 1
+#define DEFAULT_PIPELINE_DEPTH 0
 
-// global variables (good place for changing settings)
-int g_numVoices = NUM_DEFALUT_VOICES;
-StkFloat g_volume = DEFAULT_VOLUME;
-StkFloat g_panMix = 0.1;
+// names of the MIDI controllers we look for
+#define KNOBULE_NAME "Knobule"
+#define SOUND_STICK_NAME "MIMIDI 25"
+#define AKAI_MPK_NAME "MPKmini2"
 
-// global mod + pitch wheel
-int g_modAmount = 0;
-int g_pitchValue = 64;
-int g_pitchValueOffset = 64;
+// knob mappings to use in place of the built in ones, if the file is there
+#define CONTROL_MAP_FILE "controls.map"
 
-// knob layout mode
-int g_layoutMode = KNOBULE_LAYOUT;
+// Scala scale and keyboard map to tune to in place of equal temperament,
+// if the files are there
+#define SCALE_FILE "tuning.scl"
+#define KEYBOARD_MAP_FILE "tuning.kbm"
 
-// MiSynth
-MiSynth* g_micahSynth;
+// global variables (good place for changing settings)
+int g_numVoices = NUM_DEFALUT_VOICES;
+// parts, up to 16 for multi-timbral play with one part per MIDI channel
+int g_numParts = NUM_DEFAULT_PARTS;
+// blocks of latency to trade for running the voices and the effects on
+// separate cores, 0 renders both in the audio callback
+int g_pipelineDepth = DEFAULT_PIPELINE_DEPTH;
 
 // setup interrupt funcion
 bool g_done;
@@ -91,35 +91,56 @@ double printGoodbyeMessage() {
 //-----------------------------------------------------------------------------
 int audioCallback( void *outputBuffer, void *inputBuffer, unsigned int nBufferFrames,
          double streamTime, RtAudioStreamStatus status, void *dataPointer ) {
-  // set samples to point to the beginning of the buffer
-  register StkFloat *samples = (StkFloat*) outputBuffer;
-  StkFloat tickSamp;
-  StkFloat pan;
+  MiEngine *engine = (MiEngine *) dataPointer;
 
-  // loop over the buffer, ticking the synth each frame
-  for (int frameIndex = 0; frameIndex < nBufferFrames; frameIndex++) {
-    tickSamp = g_micahSynth->tick();
-    tickSamp *= g_volume;
-    pan = 0.5 + 0.5 * g_micahSynth->getStereoPan();
-    // duplicate over each channel
-    for (int chanIndex = 0; chanIndex < NUM_CHANNELS; chanIndex++){
-      if(chanIndex == 0) {
-        *samples++ = g_panMix * (tickSamp * pan) + (1.0 - g_panMix) * tickSamp;
-      } else {
-        *samples++ = g_panMix * (tickSamp * (1.0 - pan)) + (1.0 - g_panMix) * tickSamp;
-      }
-    }
-  }
+  // render the whole buffer through the engine, straight into RtAudio's
+  // buffer through a view
+  StkFramesView frames( (StkFloat *) outputBuffer, nBufferFrames, NUM_CHANNELS );
+  engine->tick( frames );
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+// name: connectDevices()
+// desc: open the controllers we care about and pick the knob layout to
+//       match: the soundstick + knobule if both are plugged in, otherwise
+//       the akai mpk mini.  Called at startup and again from the MIDI
+//       watcher thread whenever the list of MIDI ports changes (a device
+//       replugged within a second can go unnoticed, see MiMidiInput).
+//-----------------------------------------------------------------------------
+static void connectDevices( MiMidiInput *midiInput, void *data ) {
+  MiEngine *engine = (MiEngine *) data;
+
+  // if we have both a knobule and a sound stick
+  if ( midiInput->findPort( KNOBULE_NAME ) != -1 && midiInput->findPort( SOUND_STICK_NAME ) != -1 ) {
+    midiInput->closePort( AKAI_MPK_NAME );
+    if ( !midiInput->isOpen( KNOBULE_NAME ) || !midiInput->isOpen( SOUND_STICK_NAME ) )
+      std::cout << "Using the soundstick + knobule\n";
+    engine->setLayout( KNOBULE_LAYOUT );
+    midiInput->openPort( KNOBULE_NAME );
+    midiInput->openPort( SOUND_STICK_NAME );
+
+  // Elsewise use akai
+  } else if ( midiInput->findPort( AKAI_MPK_NAME ) != -1 ) {
+    midiInput->closePort( KNOBULE_NAME );
+    midiInput->closePort( SOUND_STICK_NAME );
+    if ( !midiInput->isOpen( AKAI_MPK_NAME ) )
+      std::cout << "Using the akai mpk mini\n";
+    engine->setLayout( AKAIMPK_LAYOUT );
+    midiInput->openPort( AKAI_MPK_NAME );
+
+  // Otherwise there are no midi devices we care about plugged in
+  } else {
+    midiInput->closePorts();
+    std::cout << "Please plug in soundstick + knobule or the akai mpk mini\n";
+  }
+}
+
 //-----------------------------------------------------------------------------
 // name: main()
 // desc: entry point
 //-----------------------------------------------------------------------------
 int main() {
-  // Set the global sample rate before creating class instances.
-  Stk::setSampleRate( DEFAULT_SAMPLE_RATE );
   RtAudio dac;
 
   // RtAudio stream setup
@@ -131,56 +152,31 @@ int main() {
   RtAudioFormat format = ( sizeof(StkFloat) == 8 ) ? RTAUDIO_FLOAT64 : RTAUDIO_FLOAT32;
   unsigned int bufferFrames = RT_BUFFER_SIZE;
 
-  // setup our MicahSynth
-  g_micahSynth = new MiSynth(g_numVoices);
+  // setup our MicahSynth, its memory locked so the audio thread never faults
+  MiEngine *engine = new MiEngine( g_numVoices, DEFAULT_SAMPLE_RATE, RT_BUFFER_SIZE, true, g_numParts );
+  engine->setPipelineDepth( g_pipelineDepth );
+  if ( engine->getControlMap().load( CONTROL_MAP_FILE ) ) {
+    std::cout << "Knob mappings loaded from " << CONTROL_MAP_FILE << "\n";
+  }
+  if ( engine->loadScale( SCALE_FILE ) ) {
+    std::cout << "Scale loaded from " << SCALE_FILE << "\n";
+  }
+  if ( engine->loadKeyboardMap( KEYBOARD_MAP_FILE ) ) {
+    std::cout << "Keyboard map loaded from " << KEYBOARD_MAP_FILE << "\n";
+  }
+  if ( engine->getLatency() > 0 ) {
+    std::cout << "Pipeline mode adds " << engine->getLatency() << " frames ("
+              << 1000.0 * engine->getLatency() / DEFAULT_SAMPLE_RATE << " ms) of latency\n";
+  }
 
   // Install an interrupt handler function.
   g_done = false;
   (void) signal(SIGINT, finish);
 
-  // loop variables
-  int note = 0;
-  int intensity = 0;
-  int knobNumber = 0;
-  int waveShape = 0;
-  int reverbType = 0;
-  int nHarmonics = 0;
-  StkFloat reverbSize = 0;
-  unsigned long echoLength = 0;
-  double tune = 1.0;
-  StkFloat cutoff = 440.0;
-  StkFloat resonance = 0.98;
-  StkFloat maxResonance = 0.98;
-
-  // ADSR variables
-  StkFloat A = 0.01;
-  StkFloat D = 0.2;
-  StkFloat S = 0.5;
-  StkFloat R = 0.5;
-
-  // Knobule input name
-  std::string knobuleName ("Knobule");
-  int knobuleIdNum = -1;
-
-  // MIMIDI 25 detection
-  std::string soundStickName ("MIMIDI 25");
-  int soundStickIdNum = -1;
-
-  // AKAI MPK mini detection
-  std::string akaiMPKName ("MPKmini2");
-  int akaiMPKIdNum = -1;
-
-  // MIDI variables
-  std::vector<unsigned char> message;
-  int nBytes;
-  double stamp;
-
-  // RtMidiIn creation and constructor
-  RtMidiIn  *mainMidiIn = 0;
-  RtMidiIn  *soundStickMidiIn = 0;
+  // MIDI input, every open port feeds the engine's queue
+  MiMidiInput *midiInput = 0;
   try {
-    mainMidiIn = new RtMidiIn();
-    soundStickMidiIn = new RtMidiIn();
+    midiInput = new MiMidiInput();
   }
   catch ( RtMidiError &error ) {
     error.printMessage();
@@ -188,63 +184,29 @@ int main() {
   }
 
   // Check and print MIDI inputs.
-  unsigned int nPorts = mainMidiIn->getPortCount();
+  unsigned int nPorts = midiInput->getPortCount();
   std::cout << "\nThere are " << nPorts << " MIDI input sources available.\n";
-  std::string portName;
-
-  // Find the midi ports we care about
   for ( unsigned int i=0; i<nPorts; i++ ) {
     try {
-      // check the port name
-      portName = mainMidiIn->getPortName(i);
-
-      // is it one we care about?
-      if( portName.find(knobuleName) != std::string::npos ) {
-        knobuleIdNum = i;
-      } else if ( portName.find(soundStickName) != std::string::npos ) {
-        soundStickIdNum = i;
-      } else if ( portName.find(akaiMPKName) != std::string::npos ) {
-        akaiMPKIdNum = i;
-      }
+      std::cout << "  Input Port #" << i+1 << ": " << midiInput->getPortName(i) << '\n';
     }
     catch ( RtMidiError &error ) {
       error.printMessage();
       goto cleanup;
     }
-    std::cout << "  Input Port #" << i+1 << ": " << portName << '\n';
   }
 
-  // if we have both a knobule and a sound stick
-  if(knobuleIdNum != -1 && soundStickIdNum != -1) {
-    // Open midi port at device ids
-    mainMidiIn->openPort( knobuleIdNum );
-    soundStickMidiIn->openPort( soundStickIdNum );
-
-    // Don't ignore sysex, timing, or active sensing messages.
-    mainMidiIn->ignoreTypes( false, false, false );
-    soundStickMidiIn->ignoreTypes( false, false, false );
+  // Open what's plugged in now, then keep watching so controllers can be
+  // plugged in, swapped or replugged without restarting
+  connectDevices( midiInput, engine );
+  midiInput->startWatching( &connectDevices, engine );
 
-  // Elsewise use akai
-  } else if (akaiMPKIdNum != -1) {
-    //Save a RtMidi object and logic by piggybacking on "main midi input"
-    // Open midi port at akai port id
-    mainMidiIn->openPort( akaiMPKIdNum );
-
-    // Don't ignore sysex, timing, or active sensing messages.
-    mainMidiIn->ignoreTypes( false, false, false );
-
-    // update layout mode
-    g_layoutMode = AKAIMPK_LAYOUT;
-
-  // Otherwise there are no midi devices we care about plugged in
-  } else {
-    std::cout << "Please plug in soundstick + knobule or the akai mpk mini and try again\n";
-    goto cleanup;
-  }
+  // the engine plays whatever has arrived at the start of each block
+  engine->setMidiQueue( midiInput->getQueue() );
   
   // Open and start audio stream
   try {
-    dac.openStream( &parameters, NULL, format, (unsigned int)Stk::sampleRate(), &bufferFrames, &audioCallback );
+    dac.openStream( &parameters, NULL, format, (unsigned int)engine->getContext()->sampleRate(), &bufferFrames, &audioCallback, (void *)engine );
     dac.startStream();
   }
   catch ( RtAudioError &error ) {
@@ -255,219 +217,10 @@ int main() {
   // Print Welcome
   printWelcomeMessage();
 
-  // Event loop
+  // MIDI arrives on its own threads, so there is nothing to do here but
+  // wait for ctrl-c
   while(!g_done) {
-    // check main midi (knobule or akai)
-    stamp = mainMidiIn->getMessage( &message );
-    nBytes = message.size();
-
-    // TODO: dont check this if in akai mode
-    // if there was no message, check sound stick
-    if (nBytes == 0) {
-      stamp = soundStickMidiIn->getMessage( &message );
-      nBytes = message.size();
-    }
-
-    // if there are no messages, sleep for 5ms then check again
-    if (nBytes == 0) {
-      SLEEP( 5 );
-      continue;
-    }
-
-    // Read the control Number
-    int controlNumber = (int)message[0];
-
-    // Switch!  Based on cc Number
-    switch (controlNumber) {
-      case 144: // note on
-        note = (int)message[1];
-        intensity = (int)message[2];
-        g_micahSynth->noteOn(note, intensity);
-        break;
-
-      case  128: // note off
-        g_micahSynth->noteOff((int)message[1]);
-        break;
-
-      case  176: // knobs
-        // Switch based on layout mode (akai vs knobule+ss)
-        switch(g_layoutMode) {
-          case AKAIMPK_LAYOUT:
-            knobNumber = (int)message[1];
-            intensity  = (int)message[2];
-            switch (knobNumber) {
-              case 1:  // mod wheel, filter cutoff
-                cutoff = (StkFloat)( 20.0 + intensity * 10000.0 / 128.0 );
-                g_micahSynth->setFilter(cutoff, resonance);
-                break;
-              case 2:
-                waveShape = intensity / 32;
-                g_micahSynth->setWaveShape(0, waveShape);
-                break;
-              case 3:
-                waveShape = intensity / 32;
-                g_micahSynth->setWaveShape(1, waveShape);
-                break;
-              case 4:
-                waveShape = intensity / 32;
-                g_micahSynth->setWaveShape(2, waveShape);
-                break;
-              case 5:
-                A = (StkFloat)(intensity+1) / 130.0;
-                A *= A;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 6:
-                D = (StkFloat)(intensity+1) / 130.0;
-                D *= D;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 7:
-                S = (StkFloat)(intensity+1) / 130.0;
-                S *= S;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 8:
-                R = (StkFloat)(intensity+1) / 130.0;
-                R *= R;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              }
-            break;
-          case KNOBULE_LAYOUT:
-          default:
-            knobNumber = (int)message[1];
-            intensity  = (int)message[2];
-            switch (knobNumber) {
-              case 0: // set n Harmonics for BLIT saw and square
-                if ( nHarmonics != intensity / 8 ) {
-                  nHarmonics = intensity / 8;
-                  g_micahSynth->setNHarmonics(nHarmonics);
-                }
-                break;
-              case 1: // osc 1 wave shape
-                waveShape = intensity / 32;
-                g_micahSynth->setWaveShape(0, waveShape);
-                break;
-              case 2: // osc 1 volume
-                g_micahSynth->setOscVolume(0, ((StkFloat)(intensity+1) / 130.0));
-                break;
-              case 3: // osc 2 tuning
-                tune = 0.5 + 1.5 * (intensity / 127.0);
-                g_micahSynth->setOscTuning(1, tune);
-                break;
-              case 4: // osc 2 wave shape
-                waveShape = intensity / 32;
-                g_micahSynth->setWaveShape(1, waveShape);
-                break;
-              case 5: // osc 2 volume
-                g_micahSynth->setOscVolume(1, ((StkFloat)(intensity+1) / 130.0));
-                break;
-              case 6: // osc 3 tuning
-                tune = 0.5 + 1.5 * (intensity / 127.0);
-                g_micahSynth->setOscTuning(2, tune);
-                break;
-              case 7: // osc 3 wave shape
-                waveShape = intensity / 32;
-                g_micahSynth->setWaveShape(2, waveShape);
-                break;
-              case 8: // osc 3 volume
-                g_micahSynth->setOscVolume(2, ((StkFloat)(intensity+1) / 130.0));
-                break;
-              case 9: // filter cutoff
-                cutoff = (StkFloat)( 20.0 + intensity * 10000.0 / 128.0 );
-                g_micahSynth->setFilter(cutoff, resonance);
-                break;
-              case 10: // filter resonance
-                resonance = (StkFloat)((intensity+1)/ 130.0 );
-                g_micahSynth->setFilter(cutoff, resonance);
-                break;
-              case 11: // filter mix
-                g_micahSynth->setFilterMix((StkFloat)(intensity+1) / 130.0);
-                break;
-              case 12: // echo feedback
-                g_micahSynth->setEchoFeedback((StkFloat)(intensity+1) / 130.0);
-                break;
-              case 13: // echo length
-                echoLength = 44100 * intensity / 128.0;
-                g_micahSynth->setEchoLength(echoLength);
-                break;
-              case 14: // echo mix
-                g_micahSynth->setEchoMix((StkFloat)(intensity+1) / 130.0);
-                break;
-              case 15: // reverb size
-                reverbSize = intensity / 16 + 0.1;
-                g_micahSynth->setReverbSize(reverbSize);
-                break;
-              case 16: // reverb type
-                reverbType = intensity / 32;
-                g_micahSynth->setReverbType(reverbType);
-                break;
-              case 17: // reverb mix
-                g_micahSynth->setReverbMix((StkFloat)(intensity+1) / 130.0);
-                break;
-              case 18: // tremelo frequency
-                g_micahSynth->setLFOFrequency(0, 0.25 + LFO_SPEED_MAX * (StkFloat)(intensity+1) / 130.0);
-                break;
-              case 19: // tremelo depth
-                g_micahSynth->setLFODepth(0, (StkFloat)(intensity+1) / 130.0);
-                break;
-              case 25: // tremelo mix
-                g_micahSynth->setTremeloMix((StkFloat)(intensity) / 128.0);
-                break;
-              case 21: // stereo pan frequency
-                g_micahSynth->setLFOFrequency(1, 0.25 + LFO_SPEED_MAX * (StkFloat)(intensity+1) / 130.0);
-                break;
-              case 26: // stereo pan depth
-                g_micahSynth->setLFODepth(1, (StkFloat)(intensity+1) / 130.0);
-                break;
-              case 20: // stereo pan mix
-                g_panMix = (StkFloat)(intensity) / 128.0;
-                break;
-              case 22: // Attack
-                A = (StkFloat)(intensity+1) / 130.0;
-                A *= A;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 23: // Delay
-                D = (StkFloat)(intensity+1) / 130.0;
-                D *= D;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 24: // Release
-                R = (StkFloat)(intensity+1) / 130.0;
-                R *= R;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 27: // master volume top right
-                g_volume = (StkFloat)(intensity+1) / 130.0;
-              case 28: // Sustain (out of order to be replaced by slider)
-                S = (StkFloat)(intensity+1) / 130.0;
-                S *= S;
-                g_micahSynth->setADSR(A, D, S, R);
-                break;
-              case 29: // bottom right not used
-                break;
-              default:
-                break;
-              }
-          break;
-        }
-        break;
-
-      case 224: // pitch wheel
-        g_pitchValue = (int)message[2];
-        break;
-
-      default:
-        std::cout << "\n \
-          Zero: " << (int)message[0] << " \n \
-          One: " << (int)message[1] << " \n \
-          Two: " << (int)message[2] << " \n \n";
-    }
-
-    // Sleep for 5 milliseconds
-    SLEEP( 5 );
+    SLEEP( 100 );
   }
   
   // print goodbye message
@@ -481,7 +234,7 @@ int main() {
     error.printMessage();
   }
  cleanup:
-  delete mainMidiIn;
-  delete soundStickMidiIn;
+  delete midiInput;
+  delete engine;
   return 0;
 }
\ No newline at end of file
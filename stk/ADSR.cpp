@@ -9,14 +9,27 @@
     the ADSR::RELEASE state.  All rate, target and level settings must
     be non-negative.  All time settings must be positive.
 
+    Each segment is either a linear ramp (the default) or an
+    exponential curve that aims past the segment's end level and
+    crosses it after the same number of samples as the linear ramp.
+    The StkFrames tick() computes each segment in closed form and
+    switches segments at the exact sample they end on.
+
     by Perry R. Cook and Gary P. Scavone, 1995--2017.
 */
 /***************************************************/
 
 #include "ADSR.h"
+#include <cmath>
 
 namespace stk {
 
+// How far past its end level an exponential segment aims, as a fraction
+// of the segment's span.  A large overshoot keeps the attack close to a
+// straight line, a tiny one gives decay and release a natural tail.
+const StkFloat ATTACK_OVERSHOOT = 0.3;
+const StkFloat DECAY_OVERSHOOT = 0.0001;
+
 ADSR :: ADSR( void )
 {
   target_ = 0.0;
@@ -27,6 +40,9 @@ ADSR :: ADSR( void )
   releaseTime_ = -1.0;
   sustainLevel_ = 0.5;
   state_ = IDLE;
+  curve_ = LINEAR;
+  curveTarget_ = 0.0;
+  curveCoef_ = 0.0;
   Stk::addSampleRateAlert( this );
 }
 
@@ -41,13 +57,139 @@ void ADSR :: sampleRateChanged( StkFloat newRate, StkFloat oldRate )
     attackRate_ = oldRate * attackRate_ / newRate;
     decayRate_ = oldRate * decayRate_ / newRate;
     releaseRate_ = oldRate * releaseRate_ / newRate;
+    this->updateCurve();
+  }
+}
+
+void ADSR :: setCurve( int curve )
+{
+  if ( curve != LINEAR && curve != EXPONENTIAL ) {
+    oStream_ << "ADSR::setCurve: unknown curve type!";
+    handleError( StkError::WARNING ); return;
+  }
+
+  curve_ = curve;
+  this->updateCurve();
+}
+
+void ADSR :: updateCurve( void )
+{
+  if ( curve_ != EXPONENTIAL ) return;
+
+  // The exponential segment runs from the current value towards an
+  // overshoot target, with the coefficient chosen so it crosses the
+  // segment's end level after as many samples as the linear ramp takes.
+  StkFloat span, rate, overshoot;
+  switch ( state_ ) {
+  case ATTACK:
+    span = target_ - value_;
+    rate = attackRate_;
+    overshoot = ATTACK_OVERSHOOT;
+    break;
+  case DECAY:
+    span = sustainLevel_ - value_;
+    rate = decayRate_;
+    overshoot = DECAY_OVERSHOOT;
+    break;
+  case RELEASE:
+    span = -value_;
+    rate = releaseRate_;
+    overshoot = DECAY_OVERSHOOT;
+    break;
+  default:
+    return;
+  }
+
+  curveTarget_ = value_ + span * ( 1.0 + overshoot );
+  StkFloat samples = fabs( span ) / rate;
+  if ( samples > 0.0 )
+    curveCoef_ = exp( -log( ( 1.0 + overshoot ) / overshoot ) / samples );
+  else
+    curveCoef_ = 0.0;
+}
+
+unsigned int ADSR :: tickSegment( StkFloat *samples, unsigned int nFrames, unsigned int hop )
+{
+  StkFloat end, rate, steps;
+  switch ( state_ ) {
+  case ATTACK:
+    end = target_;
+    rate = attackRate_;
+    break;
+  case DECAY:
+    end = sustainLevel_;
+    rate = ( value_ > sustainLevel_ ) ? -decayRate_ : decayRate_;
+    break;
+  case RELEASE:
+    end = 0.0;
+    rate = -releaseRate_;
+    break;
+  default:
+    // SUSTAIN and IDLE hold their value
+    for ( unsigned int i=0; i<nFrames; i++, samples += hop )
+      *samples = value_;
+    return nFrames;
+  }
+
+  // Number of samples up to and including the one that reaches the end
+  // level.  A segment that is already there ends on its first sample, one
+  // that never gets there (zero rate) runs on past this block.
+  if ( curve_ == EXPONENTIAL ) {
+    if ( curveCoef_ >= 1.0 ) steps = nFrames + 1.0;
+    else steps = ceil( log( ( end - curveTarget_ ) / ( value_ - curveTarget_ ) ) / log( curveCoef_ ) );
+  }
+  else steps = ceil( ( end - value_ ) / rate );
+  if ( !( steps > 1.0 ) ) steps = 1.0;
+
+  bool segmentEnds = steps <= nFrames;
+  unsigned int count = segmentEnds ? (unsigned int) steps : nFrames;
+  unsigned int ramp = segmentEnds ? count - 1 : count;
+  unsigned int i;
+
+  if ( curve_ == EXPONENTIAL ) {
+    // value[i] = target + ( value - target ) * coef^(i+1), eight samples at
+    // a time from a table of coef^1 ... coef^8
+    StkFloat powers[8];
+    powers[0] = curveCoef_;
+    for ( i=1; i<8; i++ ) powers[i] = powers[i-1] * curveCoef_;
+
+    StkFloat offset = value_ - curveTarget_;
+    for ( i=0; i+8<=ramp; i+=8 ) {
+      for ( unsigned int j=0; j<8; j++ )
+        samples[(i+j) * hop] = curveTarget_ + offset * powers[j];
+      offset *= powers[7];
+    }
+    for ( unsigned int j=0; i<ramp; i++, j++ )
+      samples[i * hop] = curveTarget_ + offset * powers[j];
+    if ( ramp > 0 ) value_ = samples[(ramp-1) * hop];
+  }
+  else {
+    for ( i=0; i<ramp; i++ )
+      samples[i * hop] = value_ + rate * ( i + 1 );
+    value_ += rate * ramp;
+  }
+
+  if ( segmentEnds ) {
+    samples[ramp * hop] = end;
+    value_ = end;
+    if ( state_ == ATTACK ) {
+      target_ = sustainLevel_;
+      state_ = DECAY;
+      this->updateCurve();
+    }
+    else if ( state_ == DECAY ) state_ = SUSTAIN;
+    else state_ = IDLE;
   }
+
+  lastFrame_[0] = value_;
+  return count;
 }
 
 void ADSR :: keyOn()
 {
   if ( target_ <= 0.0 ) target_ = 1.0;
   state_ = ATTACK;
+  this->updateCurve();
 }
 
 void ADSR :: keyOff()
@@ -60,7 +202,8 @@ void ADSR :: keyOff()
   // Only update if we have set a TIME rather than a RATE,
   // in which case releaseTime_ will be -1
   if ( releaseTime_ > 0.0 )
-	  releaseRate_ = value_ / ( releaseTime_ * Stk::sampleRate() );
+	  releaseRate_ = value_ / ( releaseTime_ * context_->sampleRate() );
+  this->updateCurve();
 }
 
 void ADSR :: setAttackRate( StkFloat rate )
@@ -71,6 +214,7 @@ void ADSR :: setAttackRate( StkFloat rate )
   }
 
   attackRate_ = rate;
+  this->updateCurve();
 }
 
 void ADSR :: setAttackTarget( StkFloat target )
@@ -81,6 +225,7 @@ void ADSR :: setAttackTarget( StkFloat target )
   }
 
   target_ = target;
+  this->updateCurve();
 }
 
 void ADSR :: setDecayRate( StkFloat rate )
@@ -91,6 +236,7 @@ void ADSR :: setDecayRate( StkFloat rate )
   }
 
   decayRate_ = rate;
+  this->updateCurve();
 }
 
 void ADSR :: setSustainLevel( StkFloat level )
@@ -101,6 +247,7 @@ void ADSR :: setSustainLevel( StkFloat level )
   }
 
   sustainLevel_ = level;
+  this->updateCurve();
 }
 
 void ADSR :: setReleaseRate( StkFloat rate )
@@ -114,6 +261,7 @@ void ADSR :: setReleaseRate( StkFloat rate )
 
   // Set to negative value so we don't update the release rate on keyOff()
   releaseTime_ = -1.0;
+  this->updateCurve();
 }
 
 void ADSR :: setAttackTime( StkFloat time )
@@ -123,7 +271,8 @@ void ADSR :: setAttackTime( StkFloat time )
     handleError( StkError::WARNING ); return;
   }
 
-  attackRate_ = 1.0 / ( time * Stk::sampleRate() );
+  attackRate_ = 1.0 / ( time * context_->sampleRate() );
+  this->updateCurve();
 }
 
 void ADSR :: setDecayTime( StkFloat time )
@@ -133,7 +282,8 @@ void ADSR :: setDecayTime( StkFloat time )
     handleError( StkError::WARNING ); return;
   }
 
-  decayRate_ = (1.0 - sustainLevel_) / ( time * Stk::sampleRate() );
+  decayRate_ = (1.0 - sustainLevel_) / ( time * context_->sampleRate() );
+  this->updateCurve();
 }
 
 void ADSR :: setReleaseTime( StkFloat time )
@@ -143,8 +293,9 @@ void ADSR :: setReleaseTime( StkFloat time )
     handleError( StkError::WARNING ); return;
   }
 
-  releaseRate_ = sustainLevel_ / ( time * Stk::sampleRate() );
+  releaseRate_ = sustainLevel_ / ( time * context_->sampleRate() );
   releaseTime_ = time;
+  this->updateCurve();
 }
 
 void ADSR :: setAllTimes( StkFloat aTime, StkFloat dTime, StkFloat sLevel, StkFloat rTime )
@@ -155,6 +306,21 @@ void ADSR :: setAllTimes( StkFloat aTime, StkFloat dTime, StkFloat sLevel, StkFl
   this->setReleaseTime( rTime );
 }
 
+void ADSR :: setAllRates( StkFloat aRate, StkFloat dRate, StkFloat sLevel, StkFloat rRate, StkFloat rTime )
+{
+  if ( aRate < 0.0 || dRate < 0.0 || sLevel < 0.0 || rRate < 0.0 ) {
+    oStream_ << "ADSR::setAllRates: negative rates or level not allowed!";
+    handleError( StkError::WARNING ); return;
+  }
+
+  attackRate_ = aRate;
+  decayRate_ = dRate;
+  sustainLevel_ = sLevel;
+  releaseRate_ = rRate;
+  releaseTime_ = ( rTime > 0.0 ) ? rTime : -1.0;
+  this->updateCurve();
+}
+
 void ADSR :: setTarget( StkFloat target )
 {
   if ( target < 0.0 ) {
@@ -167,6 +333,7 @@ void ADSR :: setTarget( StkFloat target )
   this->setSustainLevel( target_ );
   if ( value_ < target_ ) state_ = ATTACK;
   if ( value_ > target_ ) state_ = DECAY;
+  this->updateCurve();
 }
 
 void ADSR :: setValue( StkFloat value )
@@ -17,6 +17,12 @@ namespace stk {
     be non-negative.  All time settings are in seconds and must be
     positive.
 
+    Each segment is either a linear ramp (the default) or an
+    exponential curve that aims past the segment's end level and
+    crosses it after the same number of samples as the linear ramp.
+    The StkFrames tick() computes each segment in closed form and
+    switches segments at the exact sample they end on.
+
     by Perry R. Cook and Gary P. Scavone, 1995--2017.
 */
 /***************************************************/
@@ -34,6 +40,12 @@ class ADSR : public Generator
     IDLE      /*!< Before attack / after release */
   };
 
+  //! ADSR segment curves.
+  enum {
+    LINEAR,      /*!< Straight line ramps (default) */
+    EXPONENTIAL  /*!< Exponential ramps */
+  };
+
   //! Default constructor.
   ADSR( void );
 
@@ -73,9 +85,25 @@ class ADSR : public Generator
   //! Set sustain level and attack, decay, and release time durations (seconds).
   void setAllTimes( StkFloat aTime, StkFloat dTime, StkFloat sLevel, StkFloat rTime );
 
+  //! Set the attack, decay and release rates and the sustain level at once.
+  /*!
+    The rates are in gain per sample, as setAllTimes() would compute
+    them.  A positive \e rTime is kept so keyOff() rescales the release
+    rate to the level released from, as after setReleaseTime().  The
+    curve is updated once, so this is the cheap way to hand many
+    envelopes the same precomputed settings.
+  */
+  void setAllRates( StkFloat aRate, StkFloat dRate, StkFloat sLevel, StkFloat rRate, StkFloat rTime = -1.0 );
+
   //! Set a sustain target value and attack or decay from current value to target.
   void setTarget( StkFloat target );
 
+  //! Set the segment curve (ADSR::LINEAR or ADSR::EXPONENTIAL).
+  void setCurve( int curve );
+
+  //! Return the segment curve (ADSR::LINEAR or ADSR::EXPONENTIAL).
+  int getCurve( void ) const { return curve_; };
+
   //! Return the current envelope \e state (ATTACK, DECAY, SUSTAIN, RELEASE, IDLE).
   int getState( void ) const { return state_; };
 
@@ -101,8 +129,12 @@ class ADSR : public Generator
  protected:  
 
   void sampleRateChanged( StkFloat newRate, StkFloat oldRate );
+  void updateCurve( void );
+  unsigned int tickSegment( StkFloat *samples, unsigned int nFrames, unsigned int hop );
+  StkFloat curveStep( void ) const { return curveTarget_ + ( value_ - curveTarget_ ) * curveCoef_; };
 
   int state_;
+  int curve_;
   StkFloat value_;
   StkFloat target_;
   StkFloat attackRate_;
@@ -110,6 +142,8 @@ class ADSR : public Generator
   StkFloat releaseRate_;
   StkFloat releaseTime_;
   StkFloat sustainLevel_;
+  StkFloat curveTarget_;
+  StkFloat curveCoef_;
 };
 
 inline StkFloat ADSR :: tick( void )
@@ -117,25 +151,29 @@ inline StkFloat ADSR :: tick( void )
   switch ( state_ ) {
 
   case ATTACK:
-    value_ += attackRate_;
+    if ( curve_ == EXPONENTIAL ) value_ = this->curveStep();
+    else value_ += attackRate_;
     if ( value_ >= target_ ) {
       value_ = target_;
       target_ = sustainLevel_;
 	    state_ = DECAY;
+      this->updateCurve();
     }
     lastFrame_[0] = value_;
     break;
 
   case DECAY:
     if ( value_ > sustainLevel_ ) {
-      value_ -= decayRate_;
+      if ( curve_ == EXPONENTIAL ) value_ = this->curveStep();
+      else value_ -= decayRate_;
       if ( value_ <= sustainLevel_ ) {
         value_ = sustainLevel_;
         state_ = SUSTAIN;
       }
     }
     else {
-      value_ += decayRate_; // attack target < sustain level
+      if ( curve_ == EXPONENTIAL ) value_ = this->curveStep();
+      else value_ += decayRate_; // attack target < sustain level
       if ( value_ >= sustainLevel_ ) {
         value_ = sustainLevel_;
         state_ = SUSTAIN;
@@ -145,7 +183,8 @@ inline StkFloat ADSR :: tick( void )
     break;
 
   case RELEASE:
-    value_ -= releaseRate_;
+    if ( curve_ == EXPONENTIAL ) value_ = this->curveStep();
+    else value_ -= releaseRate_;
     if ( value_ <= 0.0 ) {
       value_ = 0.0;
       state_ = IDLE;
@@ -168,8 +207,12 @@ inline StkFrames& ADSR :: tick( StkFrames& frames, unsigned int channel )
 
   StkFloat *samples = &frames[channel];
   unsigned int hop = frames.channels();
-  for ( unsigned int i=0; i<frames.frames(); i++, samples += hop )
-    *samples = ADSR::tick();
+  unsigned int nFrames = frames.frames();
+  for ( unsigned int i=0; i<nFrames; ) {
+    unsigned int count = tickSegment( samples, nFrames - i, hop );
+    samples += count * hop;
+    i += count;
+  }
 
   return frames;
 }
@@ -121,6 +121,7 @@ inline StkFloat BiQuad :: tick( StkFloat input )
   inputs_[0] = gain_ * input;
   lastFrame_[0] = b_[0] * inputs_[0] + b_[1] * inputs_[1] + b_[2] * inputs_[2];
   lastFrame_[0] -= a_[2] * outputs_[2] + a_[1] * outputs_[1];
+  lastFrame_[0] = undenormalize( lastFrame_[0] );
   inputs_[2] = inputs_[1];
   inputs_[1] = inputs_[0];
   outputs_[2] = outputs_[1];
@@ -54,7 +54,7 @@ void Blit :: setFrequency( StkFloat frequency )
     handleError( StkError::WARNING ); return;
   }
 
-  p_ = Stk::sampleRate() / frequency;
+  p_ = context_->sampleRate() / frequency;
   rate_ = PI / p_;
   this->updateHarmonics();
 }
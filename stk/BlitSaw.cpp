@@ -53,7 +53,7 @@ void BlitSaw :: setFrequency( StkFloat frequency )
     handleError( StkError::WARNING ); return;
   }
 
-  p_ = Stk::sampleRate() / frequency;
+  p_ = context_->sampleRate() / frequency;
   C2_ = 1 / p_;
   rate_ = PI * C2_;
   this->updateHarmonics();
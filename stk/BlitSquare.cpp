@@ -68,7 +68,7 @@ void BlitSquare :: setFrequency( StkFloat frequency )
   // By using an even value of the parameter M, we get a bipolar blit
   // waveform at half the blit frequency.  Thus, we need to scale the
   // frequency value here by 0.5. (GPS, 2006).
-  p_ = 0.5 * Stk::sampleRate() / frequency;
+  p_ = 0.5 * context_->sampleRate() / frequency;
   rate_ = PI / p_;
   this->updateHarmonics();
 }
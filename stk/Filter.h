@@ -92,12 +92,12 @@ inline void Filter :: clear( void )
 
 inline StkFloat Filter :: phaseDelay( StkFloat frequency )
 {
-  if ( frequency <= 0.0 || frequency > 0.5 * Stk::sampleRate() ) {
+  if ( frequency <= 0.0 || frequency > 0.5 * context_->sampleRate() ) {
     oStream_ << "Filter::phaseDelay: argument (" << frequency << ") is out of range!";
     handleError( StkError::WARNING ); return 0.0;
   }
 
-  StkFloat omegaT = 2 * PI * frequency / Stk::sampleRate();
+  StkFloat omegaT = 2 * PI * frequency / context_->sampleRate();
   StkFloat real = 0.0, imag = 0.0;
   for ( unsigned int i=0; i<b_.size(); i++ ) {
     real += b_[i] * std::cos( i * omegaT );
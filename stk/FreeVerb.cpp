@@ -27,8 +27,8 @@ const StkFloat FreeVerb::scaleDry = 2;
 const StkFloat FreeVerb::scaleDamp = 0.4;
 const StkFloat FreeVerb::scaleRoom = 0.28;
 const StkFloat FreeVerb::offsetRoom = 0.7;
-int FreeVerb::cDelayLengths[] = {1617, 1557, 1491, 1422, 1356, 1277, 1188, 1116};
-int FreeVerb::aDelayLengths[] = {225, 556, 441, 341};
+const int FreeVerb::cDelayLengths[] = {1617, 1557, 1491, 1422, 1356, 1277, 1188, 1116};
+const int FreeVerb::aDelayLengths[] = {225, 556, 441, 341};
 
 FreeVerb::FreeVerb( void )
 {
@@ -46,34 +46,27 @@ FreeVerb::FreeVerb( void )
   gain_ = fixedGain;      // input gain before sending to filters
   g_ = 0.5;               // allpass coefficient, immutable in FreeVerb
 
-  // Scale delay line lengths according to the current sampling rate
-  double fsScale = Stk::sampleRate() / 44100.0;
-  if ( fsScale != 1.0 ) {
-    // scale comb filter delay lines
-    for ( int i = 0; i < nCombs; i++ ) {
-      cDelayLengths[i] = (int) floor(fsScale * cDelayLengths[i]);
-    }
-
-    // Scale allpass filter delay lines
-    for ( int i = 0; i < nAllpasses; i++ ) {
-      aDelayLengths[i] = (int) floor(fsScale * aDelayLengths[i]);
-    }
-  }
+  // Scale delay line lengths according to the current sampling rate.
+  // The scaled lengths are local, the tuning tables stay as they are
+  // for the next instance (which may run at another rate).
+  double fsScale = context_->sampleRate() / 44100.0;
 
   // Initialize delay lines for the LBFC filters
   for ( int i = 0; i < nCombs; i++ ) {
-    combDelayL_[i].setMaximumDelay( cDelayLengths[i] );
-    combDelayL_[i].setDelay( cDelayLengths[i] );
-    combDelayR_[i].setMaximumDelay( cDelayLengths[i] + stereoSpread );
-    combDelayR_[i].setDelay( cDelayLengths[i] + stereoSpread );
+    int length = (int) floor(fsScale * cDelayLengths[i]);
+    combDelayL_[i].setMaximumDelay( length );
+    combDelayL_[i].setDelay( length );
+    combDelayR_[i].setMaximumDelay( length + stereoSpread );
+    combDelayR_[i].setDelay( length + stereoSpread );
   }
 
   // initialize delay lines for the allpass filters
   for (int i = 0; i < nAllpasses; i++) {
-    allPassDelayL_[i].setMaximumDelay( aDelayLengths[i] );
-    allPassDelayL_[i].setDelay( aDelayLengths[i] );
-    allPassDelayR_[i].setMaximumDelay( aDelayLengths[i] + stereoSpread );
-    allPassDelayR_[i].setDelay( aDelayLengths[i] + stereoSpread );
+    int length = (int) floor(fsScale * aDelayLengths[i]);
+    allPassDelayL_[i].setMaximumDelay( length );
+    allPassDelayL_[i].setDelay( length );
+    allPassDelayR_[i].setMaximumDelay( length + stereoSpread );
+    allPassDelayR_[i].setDelay( length + stereoSpread );
   }
 }
 
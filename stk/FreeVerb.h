@@ -89,6 +89,14 @@ class FreeVerb : public Effect
   */
   StkFloat tick( StkFloat inputL, StkFloat inputR = 0.0, unsigned int channel = 0 );
 
+  //! Input one or two samples to the effect and return both channels of the computed stereo frame.
+  /*!
+    The left and right paths through the comb and allpass filters
+    are computed together as two-lane vectors and the result is also
+    stored in the lastFrame() object.
+  */
+  StkFloat2 tickStereo( StkFloat inputL, StkFloat inputR = 0.0 );
+
   //! Take two channels of the StkFrames object as inputs to the effect and replace with stereo outputs.
   /*!
     The StkFrames argument reference is returned.  The stereo
@@ -120,14 +128,6 @@ class FreeVerb : public Effect
   //! Update interdependent parameters.
   void update( void );
 
-  // Clamp very small floats to zero, version from
-  // http://music.columbia.edu/pipermail/linux-audio-user/2004-July/013489.html .
-  // However, this is for 32-bit floats only.
-  //static inline StkFloat undenormalize( volatile StkFloat s ) { 
-  //  s += 9.8607615E-32f; 
-  //  return s - 9.8607615E-32f; 
-  //}
-    
   static const int nCombs = 8;
   static const int nAllpasses = 4;
   static const int stereoSpread = 23;
@@ -139,8 +139,8 @@ class FreeVerb : public Effect
   static const StkFloat offsetRoom;
 
   // Delay line lengths for 44100Hz sampling rate.
-  static int cDelayLengths[nCombs];
-  static int aDelayLengths[nAllpasses];
+  static const int cDelayLengths[nCombs];
+  static const int aDelayLengths[nAllpasses];
 
   StkFloat g_;        // allpass coefficient
   StkFloat gain_;
@@ -174,76 +174,52 @@ inline StkFloat FreeVerb :: lastOut( unsigned int channel )
   return lastFrame_[channel];
 }
 
-inline StkFloat FreeVerb::tick( StkFloat inputL, StkFloat inputR, unsigned int channel )
+inline StkFloat2 FreeVerb::tickStereo( StkFloat inputL, StkFloat inputR )
 {
-#if defined(_STK_DEBUG_)
-  if ( channel > 1 ) {
-    oStream_ << "FreeVerb::tick(): channel argument must be less than 2!";
-    handleError(StkError::FUNCTION_ARGUMENT);
-  }
-#endif
-
   StkFloat fInput = (inputL + inputR) * gain_;
-  StkFloat outL = 0.0;
-  StkFloat outR = 0.0;
+  StkFloat2 out = { 0.0, 0.0 };
 
-  // Parallel LBCF filters
+  // Parallel LBCF filters, left and right channels in one vector
   for ( int i = 0; i < nCombs; i++ ) {
-    // Left channel
-    //StkFloat yn = fInput + (roomSize_ * FreeVerb::undenormalize(combLPL_[i].tick(FreeVerb::undenormalize(combDelayL_[i].nextOut()))));
-    StkFloat yn = fInput + (roomSize_ * combLPL_[i].tick( combDelayL_[i].nextOut() ) );
-    combDelayL_[i].tick(yn);
-    outL += yn;
-
-    // Right channel
-    //yn = fInput + (roomSize_ * FreeVerb::undenormalize(combLPR_[i].tick(FreeVerb::undenormalize(combDelayR_[i].nextOut()))));
-    yn = fInput + (roomSize_ * combLPR_[i].tick( combDelayR_[i].nextOut() ) );
-    combDelayR_[i].tick(yn);
-    outR += yn;
+    StkFloat2 fb = { combLPL_[i].tick( combDelayL_[i].nextOut() ),
+                     combLPR_[i].tick( combDelayR_[i].nextOut() ) };
+    StkFloat2 yn = undenormalize( fInput + roomSize_ * fb );
+    combDelayL_[i].tick( yn[0] );
+    combDelayR_[i].tick( yn[1] );
+    out += yn;
   }
 
-  // Series allpass filters
+  // Series allpass filters, left and right channels in one vector
   for ( int i = 0; i < nAllpasses; i++ ) {
-    // Left channel
-    //StkFloat vn_m = FreeVerb::undenormalize(allPassDelayL_[i].nextOut());
-    StkFloat vn_m = allPassDelayL_[i].nextOut();
-    StkFloat vn = outL + (g_ * vn_m);
-    allPassDelayL_[i].tick(vn);
-        
-    // calculate output
-    outL = -vn + (1.0 + g_)*vn_m;
-
-    // Right channel
-    //vn_m = FreeVerb::undenormalize(allPassDelayR_[i].nextOut());
-    vn_m = allPassDelayR_[i].nextOut();
-    vn = outR + (g_ * vn_m);
-    allPassDelayR_[i].tick(vn);
+    StkFloat2 vn_m = { allPassDelayL_[i].nextOut(), allPassDelayR_[i].nextOut() };
+    StkFloat2 vn = undenormalize( out + g_ * vn_m );
+    allPassDelayL_[i].tick( vn[0] );
+    allPassDelayR_[i].tick( vn[1] );
 
     // calculate output
-    outR = -vn + (1.0 + g_)*vn_m;
+    out = -vn + (1.0 + g_) * vn_m;
   }
 
   // Mix output
-  lastFrame_[0] = outL*wet1_ + outR*wet2_ + inputL*dry_;
-  lastFrame_[1] = outR*wet1_ + outL*wet2_ + inputR*dry_;
+  StkFloat2 crossed = { out[1], out[0] };
+  StkFloat2 input = { inputL, inputR };
+  out = out * wet1_ + crossed * wet2_ + input * dry_;
+  lastFrame_[0] = out[0];
+  lastFrame_[1] = out[1];
 
-  /*
-  // Hard limiter ... there's not much else we can do at this point
-  if ( lastFrame_[0] >= 1.0 ) {
-    lastFrame_[0] = 0.9999;
-  }
-  if ( lastFrame_[0] <= -1.0 ) {
-    lastFrame_[0] = -0.9999;
-  }
-  if ( lastFrame_[1] >= 1.0 ) {
-    lastFrame_[1] = 0.9999;
-  }
-  if ( lastFrame_[1] <= -1.0 ) {
-    lastFrame_[1] = -0.9999;
+  return out;
+}
+
+inline StkFloat FreeVerb::tick( StkFloat inputL, StkFloat inputR, unsigned int channel )
+{
+#if defined(_STK_DEBUG_)
+  if ( channel > 1 ) {
+    oStream_ << "FreeVerb::tick(): channel argument must be less than 2!";
+    handleError(StkError::FUNCTION_ARGUMENT);
   }
-  */
+#endif
 
-  return lastFrame_[channel];
+  return tickStereo( inputL, inputR )[channel];
 }
 
 }
@@ -20,6 +20,7 @@
 /***************************************************/
 
 #include "JCRev.h"
+#include "StkMath.h"
 #include <cmath>
 
 namespace stk {
@@ -35,7 +36,7 @@ JCRev :: JCRev( StkFloat T60 )
 
   // Delay lengths for 44100 Hz sample rate.
   int lengths[9] = {1116, 1356, 1422, 1617, 225, 341, 441, 211, 179};
-  double scaler = Stk::sampleRate() / 44100.0;
+  double scaler = context_->sampleRate() / 44100.0;
 
   int delay, i;
   if ( scaler != 1.0 ) {
@@ -90,8 +91,27 @@ void JCRev :: setT60( StkFloat T60 )
     handleError( StkError::WARNING ); return;
   }
 
-  for ( int i=0; i<4; i++ )
-    combCoefficient_[i] = pow(10.0, (-3.0 * combDelays_[i].getDelay() / (T60 * Stk::sampleRate())));
+  StkFloat coefficients[nCombs];
+  this->getCombCoefficients( T60, coefficients );
+  this->setCombCoefficients( coefficients );
+}
+
+bool JCRev :: getCombCoefficients( StkFloat T60, StkFloat *coefficients )
+{
+  if ( T60 <= 0.0 ) {
+    oStream_ << "JCRev::getCombCoefficients: T60 argument (" << T60 << ") must be positive!";
+    handleError( StkError::WARNING ); return false;
+  }
+
+  for ( int i=0; i<nCombs; i++ )
+    coefficients[i] = StkMath::pow(10.0, (-3.0 * combDelays_[i].getDelay() / (T60 * context_->sampleRate())));
+  return true;
+}
+
+void JCRev :: setCombCoefficients( const StkFloat *coefficients )
+{
+  for ( int i=0; i<nCombs; i++ )
+    combCoefficient_[i] = coefficients[i];
 }
 
 StkFrames& JCRev :: tick( StkFrames& frames, unsigned int channel )
@@ -37,9 +37,24 @@ class JCRev : public Effect
   //! Reset and clear all internal state.
   void clear( void );
 
+  //! The number of comb filters, and so of coefficients in a comb coefficient set.
+  static const int nCombs = 4;
+
   //! Set the reverberation T60 decay time.
   void setT60( StkFloat T60 );
 
+  //! Compute the comb filter coefficients for a T60 decay time, without applying them.
+  /*!
+    Fills \c coefficients with nCombs values for setCombCoefficients(),
+    so the coefficient set can be worked out ahead of time on another
+    thread and installed later as a plain copy.  Returns false, leaving
+    \c coefficients untouched, if the T60 isn't positive.
+  */
+  bool getCombCoefficients( StkFloat T60, StkFloat *coefficients );
+
+  //! Install a set of nCombs comb filter coefficients from getCombCoefficients().
+  void setCombCoefficients( const StkFloat *coefficients );
+
   //! Return the specified channel value of the last computed stereo frame.
   /*!
     Use the lastFrame() function to get both values of the last
@@ -61,6 +76,13 @@ class JCRev : public Effect
   */
   StkFloat tick( StkFloat input, unsigned int channel = 0 );
 
+  //! Input one sample to the effect and return both channels of the computed stereo frame.
+  /*!
+    The left and right outputs are computed together as a two-lane
+    vector and are also stored in the lastFrame() object.
+  */
+  StkFloat2 tickStereo( StkFloat input );
+
   //! Take a channel of the StkFrames object as inputs to the effect and replace with stereo outputs.
   /*!
     The StkFrames argument reference is returned.  The stereo
@@ -88,12 +110,12 @@ class JCRev : public Effect
  protected:
 
   Delay allpassDelays_[3];
-  Delay combDelays_[4];
+  Delay combDelays_[nCombs];
   OnePole combFilters_[4];
   Delay outLeftDelay_;
   Delay outRightDelay_;
   StkFloat allpassCoefficient_;
-  StkFloat combCoefficient_[4];
+  StkFloat combCoefficient_[nCombs];
 
 };
 
@@ -109,55 +131,63 @@ inline StkFloat JCRev :: lastOut( unsigned int channel )
   return lastFrame_[channel];
 }
 
-inline StkFloat JCRev :: tick( StkFloat input, unsigned int channel )
+inline StkFloat2 JCRev :: tickStereo( StkFloat input )
 {
-#if defined(_STK_DEBUG_)
-  if ( channel > 1 ) {
-    oStream_ << "JCRev::tick(): channel argument must be less than 2!";
-    handleError( StkError::FUNCTION_ARGUMENT );
-  }
-#endif
-
-  StkFloat temp, temp0, temp1, temp2, temp3, temp4, temp5, temp6;
-  StkFloat filtout;
+  StkFloat temp, temp0, temp1, temp2;
 
   temp = allpassDelays_[0].lastOut();
   temp0 = allpassCoefficient_ * temp;
   temp0 += input;
+  temp0 = undenormalize( temp0 );
   allpassDelays_[0].tick(temp0);
   temp0 = -(allpassCoefficient_ * temp0) + temp;
     
   temp = allpassDelays_[1].lastOut();
   temp1 = allpassCoefficient_ * temp;
   temp1 += temp0;
+  temp1 = undenormalize( temp1 );
   allpassDelays_[1].tick(temp1);
   temp1 = -(allpassCoefficient_ * temp1) + temp;
     
   temp = allpassDelays_[2].lastOut();
   temp2 = allpassCoefficient_ * temp;
   temp2 += temp1;
+  temp2 = undenormalize( temp2 );
   allpassDelays_[2].tick(temp2);
   temp2 = -(allpassCoefficient_ * temp2) + temp;
-    
-  temp3 = temp2 + ( combFilters_[0].tick( combCoefficient_[0] * combDelays_[0].lastOut() ) );
-  temp4 = temp2 + ( combFilters_[1].tick( combCoefficient_[1] * combDelays_[1].lastOut() ) );
-  temp5 = temp2 + ( combFilters_[2].tick( combCoefficient_[2] * combDelays_[2].lastOut() ) );
-  temp6 = temp2 + ( combFilters_[3].tick( combCoefficient_[3] * combDelays_[3].lastOut() ) );
-
-  combDelays_[0].tick(temp3);
-  combDelays_[1].tick(temp4);
-  combDelays_[2].tick(temp5);
-  combDelays_[3].tick(temp6);
-
-  filtout = temp3 + temp4 + temp5 + temp6;
-
-  lastFrame_[0] = effectMix_ * (outLeftDelay_.tick(filtout));
-  lastFrame_[1] = effectMix_ * (outRightDelay_.tick(filtout));
-  temp = (1.0 - effectMix_) * input;
-  lastFrame_[0] += temp;
-  lastFrame_[1] += temp;
-    
-  return 0.7 * lastFrame_[channel];
+
+  // The four parallel combs are computed as two pairs of lanes.
+  StkFloat2 filtout = { 0.0, 0.0 };
+  for ( int i=0; i<4; i+=2 ) {
+    StkFloat2 combOut = { combDelays_[i].lastOut(), combDelays_[i+1].lastOut() };
+    StkFloat2 combCoefficient = { combCoefficient_[i], combCoefficient_[i+1] };
+    combOut *= combCoefficient;
+    StkFloat2 combIn = { combFilters_[i].tick( combOut[0] ), combFilters_[i+1].tick( combOut[1] ) };
+    combIn += temp2;
+    combDelays_[i].tick( combIn[0] );
+    combDelays_[i+1].tick( combIn[1] );
+    filtout += combIn;
+  }
+
+  temp = filtout[0] + filtout[1];
+  StkFloat2 out = { outLeftDelay_.tick( temp ), outRightDelay_.tick( temp ) };
+  out = effectMix_ * out + ( 1.0 - effectMix_ ) * input;
+  lastFrame_[0] = out[0];
+  lastFrame_[1] = out[1];
+
+  return 0.7 * out;
+}
+
+inline StkFloat JCRev :: tick( StkFloat input, unsigned int channel )
+{
+#if defined(_STK_DEBUG_)
+  if ( channel > 1 ) {
+    oStream_ << "JCRev::tick(): channel argument must be less than 2!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  return tickStereo( input )[channel];
 }
 
 } // stk namespace
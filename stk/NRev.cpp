@@ -15,6 +15,7 @@
 /***************************************************/
 
 #include "NRev.h"
+#include "StkMath.h"
 #include <cmath>
 
 namespace stk {
@@ -29,7 +30,7 @@ NRev :: NRev( StkFloat T60 )
   lastFrame_.resize( 1, 2, 0.0 ); // resize lastFrame_ for stereo output
 
   int lengths[15] = {1433, 1601, 1867, 2053, 2251, 2399, 347, 113, 37, 59, 53, 43, 37, 29, 19};
-  double scaler = Stk::sampleRate() / 25641.0;
+  double scaler = context_->sampleRate() / 25641.0;
 
   int delay, i;
   for ( i=0; i<15; i++ ) {
@@ -42,7 +43,7 @@ NRev :: NRev( StkFloat T60 )
   for ( i=0; i<6; i++ ) {
     combDelays_[i].setMaximumDelay( lengths[i] );
     combDelays_[i].setDelay( lengths[i] );
-    combCoefficient_[i] = pow(10.0, (-3 * lengths[i] / (T60 * Stk::sampleRate())));
+    combCoefficient_[i] = pow(10.0, (-3 * lengths[i] / (T60 * context_->sampleRate())));
   }
 
   for ( i=0; i<8; i++ ) {
@@ -73,8 +74,27 @@ void NRev :: setT60( StkFloat T60 )
     handleError( StkError::WARNING ); return;
   }
 
-  for ( int i=0; i<6; i++ )
-    combCoefficient_[i] = pow(10.0, (-3.0 * combDelays_[i].getDelay() / (T60 * Stk::sampleRate())));
+  StkFloat coefficients[nCombs];
+  this->getCombCoefficients( T60, coefficients );
+  this->setCombCoefficients( coefficients );
+}
+
+bool NRev :: getCombCoefficients( StkFloat T60, StkFloat *coefficients )
+{
+  if ( T60 <= 0.0 ) {
+    oStream_ << "NRev::getCombCoefficients: T60 argument (" << T60 << ") must be positive!";
+    handleError( StkError::WARNING ); return false;
+  }
+
+  for ( int i=0; i<nCombs; i++ )
+    coefficients[i] = StkMath::pow(10.0, (-3.0 * combDelays_[i].getDelay() / (T60 * context_->sampleRate())));
+  return true;
+}
+
+void NRev :: setCombCoefficients( const StkFloat *coefficients )
+{
+  for ( int i=0; i<nCombs; i++ )
+    combCoefficient_[i] = coefficients[i];
 }
 
 StkFrames& NRev :: tick( StkFrames& frames, unsigned int channel )
@@ -31,9 +31,24 @@ class NRev : public Effect
   //! Reset and clear all internal state.
   void clear( void );
 
+  //! The number of comb filters, and so of coefficients in a comb coefficient set.
+  static const int nCombs = 6;
+
   //! Set the reverberation T60 decay time.
   void setT60( StkFloat T60 );
 
+  //! Compute the comb filter coefficients for a T60 decay time, without applying them.
+  /*!
+    Fills \c coefficients with nCombs values for setCombCoefficients(),
+    so the coefficient set can be worked out ahead of time on another
+    thread and installed later as a plain copy.  Returns false, leaving
+    \c coefficients untouched, if the T60 isn't positive.
+  */
+  bool getCombCoefficients( StkFloat T60, StkFloat *coefficients );
+
+  //! Install a set of nCombs comb filter coefficients from getCombCoefficients().
+  void setCombCoefficients( const StkFloat *coefficients );
+
   //! Return the specified channel value of the last computed stereo frame.
   /*!
     Use the lastFrame() function to get both values of the last
@@ -55,6 +70,13 @@ class NRev : public Effect
   */
   StkFloat tick( StkFloat input, unsigned int channel = 0 );
 
+  //! Input one sample to the effect and return both channels of the computed stereo frame.
+  /*!
+    The left and right outputs are computed together as a two-lane
+    vector and are also stored in the lastFrame() object.
+  */
+  StkFloat2 tickStereo( StkFloat input );
+
   //! Take a channel of the StkFrames object as inputs to the effect and replace with stereo outputs.
   /*!
     The StkFrames argument reference is returned.  The stereo
@@ -82,9 +104,9 @@ class NRev : public Effect
  protected:
 
   Delay allpassDelays_[8];
-  Delay combDelays_[6];
+  Delay combDelays_[nCombs];
   StkFloat allpassCoefficient_;
-  StkFloat combCoefficient_[6];
+  StkFloat combCoefficient_[nCombs];
 	StkFloat lowpassState_;
 
 };
@@ -101,57 +123,65 @@ inline StkFloat NRev :: lastOut( unsigned int channel )
   return lastFrame_[channel];
 }
 
-inline StkFloat NRev :: tick( StkFloat input, unsigned int channel )
+inline StkFloat2 NRev :: tickStereo( StkFloat input )
 {
-#if defined(_STK_DEBUG_)
-  if ( channel > 1 ) {
-    oStream_ << "NRev::tick(): channel argument must be less than 2!";
-    handleError( StkError::FUNCTION_ARGUMENT );
-  }
-#endif
-
-  StkFloat temp, temp0, temp1, temp2, temp3;
+  StkFloat temp, temp0, temp1;
   int i;
 
-  temp0 = 0.0;
-  for ( i=0; i<6; i++ ) {
-    temp = input + (combCoefficient_[i] * combDelays_[i].lastOut());
-    temp0 += combDelays_[i].tick(temp);
+  // The six parallel combs are computed as three pairs of lanes.
+  StkFloat2 combSum = { 0.0, 0.0 };
+  for ( i=0; i<6; i+=2 ) {
+    StkFloat2 combOut = { combDelays_[i].lastOut(), combDelays_[i+1].lastOut() };
+    StkFloat2 combCoefficient = { combCoefficient_[i], combCoefficient_[i+1] };
+    StkFloat2 combIn = undenormalize( input + combCoefficient * combOut );
+    StkFloat2 tapOut = { combDelays_[i].tick( combIn[0] ), combDelays_[i+1].tick( combIn[1] ) };
+    combSum += tapOut;
   }
+  temp0 = combSum[0] + combSum[1];
 
   for ( i=0; i<3; i++ )	{
     temp = allpassDelays_[i].lastOut();
     temp1 = allpassCoefficient_ * temp;
     temp1 += temp0;
+    temp1 = undenormalize( temp1 );
     allpassDelays_[i].tick(temp1);
     temp0 = -(allpassCoefficient_ * temp1) + temp;
   }
 
 	// One-pole lowpass filter.
-  lowpassState_ = 0.7 * lowpassState_ + 0.3 * temp0;
+  lowpassState_ = undenormalize( 0.7 * lowpassState_ + 0.3 * temp0 );
   temp = allpassDelays_[3].lastOut();
   temp1 = allpassCoefficient_ * temp;
   temp1 += lowpassState_;
+  temp1 = undenormalize( temp1 );
   allpassDelays_[3].tick( temp1 );
   temp1 = -( allpassCoefficient_ * temp1 ) + temp;
-    
-  temp = allpassDelays_[4].lastOut();
-  temp2 = allpassCoefficient_ * temp;
-  temp2 += temp1;
-  allpassDelays_[4].tick( temp2 );
-  lastFrame_[0] = effectMix_*( -( allpassCoefficient_ * temp2 ) + temp );
-    
-  temp = allpassDelays_[5].lastOut();
-  temp3 = allpassCoefficient_ * temp;
-  temp3 += temp1;
-  allpassDelays_[5].tick( temp3 );
-  lastFrame_[1] = effectMix_*( - ( allpassCoefficient_ * temp3 ) + temp );
-
-  temp = ( 1.0 - effectMix_ ) * input;
-  lastFrame_[0] += temp;
-  lastFrame_[1] += temp;
-    
-  return lastFrame_[channel];
+
+  // The last two allpasses run in parallel for the left and right
+  // outputs and are computed as one two-lane operation.
+  StkFloat2 allpassOut = { allpassDelays_[4].lastOut(), allpassDelays_[5].lastOut() };
+  StkFloat2 allpassIn = undenormalize( allpassCoefficient_ * allpassOut + temp1 );
+  allpassDelays_[4].tick( allpassIn[0] );
+  allpassDelays_[5].tick( allpassIn[1] );
+  StkFloat2 out = -( allpassCoefficient_ * allpassIn ) + allpassOut;
+
+  out = effectMix_ * out + ( 1.0 - effectMix_ ) * input;
+  lastFrame_[0] = out[0];
+  lastFrame_[1] = out[1];
+
+  return out;
+}
+
+inline StkFloat NRev :: tick( StkFloat input, unsigned int channel )
+{
+#if defined(_STK_DEBUG_)
+  if ( channel > 1 ) {
+    oStream_ << "NRev::tick(): channel argument must be less than 2!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  return tickStereo( input )[channel];
 }
 
 } // stk namespace
@@ -80,7 +80,7 @@ public:
 inline StkFloat OnePole :: tick( StkFloat input )
 {
   inputs_[0] = gain_ * input;
-  lastFrame_[0] = b_[0] * inputs_[0] - a_[1] * outputs_[1];
+  lastFrame_[0] = undenormalize( b_[0] * inputs_[0] - a_[1] * outputs_[1] );
   outputs_[1] = lastFrame_[0];
 
   return lastFrame_[0];
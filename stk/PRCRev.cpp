@@ -15,6 +15,7 @@
 /***************************************************/
 
 #include "PRCRev.h"
+#include "StkMath.h"
 #include <cmath>
 
 namespace stk {
@@ -30,7 +31,7 @@ PRCRev :: PRCRev( StkFloat T60 )
 
   // Delay lengths for 44100 Hz sample rate.
   int lengths[4]= {341, 613, 1557, 2137};
-  double scaler = Stk::sampleRate() / 44100.0;
+  double scaler = context_->sampleRate() / 44100.0;
 
   // Scale the delay lengths if necessary.
   int delay, i;
@@ -74,8 +75,27 @@ void PRCRev :: setT60( StkFloat T60 )
     handleError( StkError::WARNING ); return;
   }
 
-  combCoefficient_[0] = pow(10.0, (-3.0 * combDelays_[0].getDelay() / (T60 * Stk::sampleRate())));
-  combCoefficient_[1] = pow(10.0, (-3.0 * combDelays_[1].getDelay() / (T60 * Stk::sampleRate())));
+  StkFloat coefficients[nCombs];
+  this->getCombCoefficients( T60, coefficients );
+  this->setCombCoefficients( coefficients );
+}
+
+bool PRCRev :: getCombCoefficients( StkFloat T60, StkFloat *coefficients )
+{
+  if ( T60 <= 0.0 ) {
+    oStream_ << "PRCRev::getCombCoefficients: T60 argument (" << T60 << ") must be positive!";
+    handleError( StkError::WARNING ); return false;
+  }
+
+  for ( int i=0; i<nCombs; i++ )
+    coefficients[i] = StkMath::pow(10.0, (-3.0 * combDelays_[i].getDelay() / (T60 * context_->sampleRate())));
+  return true;
+}
+
+void PRCRev :: setCombCoefficients( const StkFloat *coefficients )
+{
+  for ( int i=0; i<nCombs; i++ )
+    combCoefficient_[i] = coefficients[i];
 }
 
 StkFrames& PRCRev :: tick( StkFrames& frames, unsigned int channel )
@@ -30,9 +30,24 @@ public:
   //! Reset and clear all internal state.
   void clear( void );
 
+  //! The number of comb filters, and so of coefficients in a comb coefficient set.
+  static const int nCombs = 2;
+
   //! Set the reverberation T60 decay time.
   void setT60( StkFloat T60 );
 
+  //! Compute the comb filter coefficients for a T60 decay time, without applying them.
+  /*!
+    Fills \c coefficients with nCombs values for setCombCoefficients(),
+    so the coefficient set can be worked out ahead of time on another
+    thread and installed later as a plain copy.  Returns false, leaving
+    \c coefficients untouched, if the T60 isn't positive.
+  */
+  bool getCombCoefficients( StkFloat T60, StkFloat *coefficients );
+
+  //! Install a set of nCombs comb filter coefficients from getCombCoefficients().
+  void setCombCoefficients( const StkFloat *coefficients );
+
   //! Return the specified channel value of the last computed stereo frame.
   /*!
     Use the lastFrame() function to get both values of the last
@@ -54,6 +69,13 @@ public:
   */
   StkFloat tick( StkFloat input, unsigned int channel = 0 );
 
+  //! Input one sample to the effect and return both channels of the computed stereo frame.
+  /*!
+    The left and right outputs are computed together as a two-lane
+    vector and are also stored in the lastFrame() object.
+  */
+  StkFloat2 tickStereo( StkFloat input );
+
   //! Take a channel of the StkFrames object as inputs to the effect and replace with stereo outputs.
   /*!
     The StkFrames argument reference is returned.  The stereo
@@ -81,9 +103,9 @@ public:
 protected:
 
   Delay    allpassDelays_[2];
-  Delay    combDelays_[2];
+  Delay    combDelays_[nCombs];
   StkFloat allpassCoefficient_;
-  StkFloat combCoefficient_[2];
+  StkFloat combCoefficient_[nCombs];
 
 };
 
@@ -99,39 +121,48 @@ inline StkFloat PRCRev :: lastOut( unsigned int channel )
   return lastFrame_[channel];
 }
 
- inline StkFloat PRCRev :: tick( StkFloat input, unsigned int channel )
+inline StkFloat2 PRCRev :: tickStereo( StkFloat input )
 {
-#if defined(_STK_DEBUG_)
-  if ( channel > 1 ) {
-    oStream_ << "PRCRev::tick(): channel argument must be less than 2!";
-    handleError( StkError::FUNCTION_ARGUMENT );
-  }
-#endif
-
-  StkFloat temp, temp0, temp1, temp2, temp3;
+  StkFloat temp, temp0, temp1;
 
   temp = allpassDelays_[0].lastOut();
   temp0 = allpassCoefficient_ * temp;
   temp0 += input;
+  temp0 = undenormalize( temp0 );
   allpassDelays_[0].tick(temp0);
   temp0 = -(allpassCoefficient_ * temp0) + temp;
     
   temp = allpassDelays_[1].lastOut();
   temp1 = allpassCoefficient_ * temp;
   temp1 += temp0;
+  temp1 = undenormalize( temp1 );
   allpassDelays_[1].tick(temp1);
   temp1 = -(allpassCoefficient_ * temp1) + temp;
-    
-  temp2 = temp1 + ( combCoefficient_[0] * combDelays_[0].lastOut() );
-  temp3 = temp1 + ( combCoefficient_[1] * combDelays_[1].lastOut() );
 
-  lastFrame_[0] = effectMix_ * (combDelays_[0].tick(temp2));
-  lastFrame_[1] = effectMix_ * (combDelays_[1].tick(temp3));
-  temp = (1.0 - effectMix_) * input;
-  lastFrame_[0] += temp;
-  lastFrame_[1] += temp;
+  // The two parallel combs feed the left and right outputs, so they
+  // are computed as one two-lane operation.
+  StkFloat2 combOut = { combDelays_[0].lastOut(), combDelays_[1].lastOut() };
+  StkFloat2 combCoefficient = { combCoefficient_[0], combCoefficient_[1] };
+  StkFloat2 combIn = undenormalize( temp1 + combCoefficient * combOut );
+  StkFloat2 out = { combDelays_[0].tick(combIn[0]), combDelays_[1].tick(combIn[1]) };
 
-  return lastFrame_[channel];
+  out = effectMix_ * out + ( 1.0 - effectMix_ ) * input;
+  lastFrame_[0] = out[0];
+  lastFrame_[1] = out[1];
+
+  return out;
+}
+
+inline StkFloat PRCRev :: tick( StkFloat input, unsigned int channel )
+{
+#if defined(_STK_DEBUG_)
+  if ( channel > 1 ) {
+    oStream_ << "PRCRev::tick(): channel argument must be less than 2!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  return tickStereo( input )[channel];
 }
 
 } // stk namespace
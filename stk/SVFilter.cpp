@@ -0,0 +1,124 @@
+/***************************************************/
+/*! \class SVFilter
+    \brief STK state-variable filter class.
+
+    This class implements a two-pole state-variable filter in its
+    trapezoidal (zero-delay feedback) form, with lowpass, bandpass,
+    highpass and notch responses.  The state holds the integrator
+    charges rather than past outputs, so the cutoff can be changed
+    every sample without the transients a direct-form biquad produces
+    under modulation.
+
+    The cutoff prewarp uses a rational approximation of tan() instead
+    of the library call, cheap enough to run per sample.
+*/
+/***************************************************/
+
+#include "SVFilter.h"
+
+namespace stk {
+
+SVFilter :: SVFilter( void ) : Filter()
+{
+  type_ = LOWPASS;
+  frequency_ = 1000.0;
+  k_ = 1.0 / 0.707;
+  ic1eq_ = 0.0;
+  ic2eq_ = 0.0;
+  this->setIntegratorGain( prewarp( frequency_, context_->sampleRate() ) );
+  this->setMix();
+
+  Stk::addSampleRateAlert( this );
+}
+
+SVFilter :: ~SVFilter( void )
+{
+  Stk::removeSampleRateAlert( this );
+}
+
+void SVFilter :: sampleRateChanged( StkFloat newRate, StkFloat /*oldRate*/ )
+{
+  if ( !ignoreSampleRateChange_ )
+    this->setIntegratorGain( prewarp( frequency_, newRate ) );
+}
+
+void SVFilter :: clear( void )
+{
+  ic1eq_ = 0.0;
+  ic2eq_ = 0.0;
+  lastFrame_[0] = 0.0;
+}
+
+void SVFilter :: setType( int type )
+{
+  if ( type < LOWPASS || type > NOTCH ) {
+    oStream_ << "SVFilter::setType: unknown filter type (" << type << ")!";
+    handleError( StkError::WARNING ); return;
+  }
+
+  type_ = type;
+  this->setMix();
+}
+
+void SVFilter :: setCutoff( StkFloat frequency )
+{
+  if ( frequency < 0.0 ) {
+    oStream_ << "SVFilter::setCutoff: argument (" << frequency << ") must be non-negative!";
+    handleError( StkError::WARNING ); return;
+  }
+
+  frequency_ = frequency;
+  this->setIntegratorGain( prewarp( frequency, context_->sampleRate() ) );
+}
+
+void SVFilter :: setQ( StkFloat q )
+{
+  if ( q <= 0.0 ) {
+    oStream_ << "SVFilter::setQ: argument (" << q << ") must be positive!";
+    handleError( StkError::WARNING ); return;
+  }
+
+  this->setDamping( 1.0 / q );
+}
+
+void SVFilter :: setDamping( StkFloat damping )
+{
+  if ( damping <= 0.0 ) {
+    oStream_ << "SVFilter::setDamping: argument (" << damping << ") must be positive!";
+    handleError( StkError::WARNING ); return;
+  }
+
+  k_ = damping;
+  this->setIntegratorGain( prewarp( frequency_, context_->sampleRate() ) );
+  this->setMix();
+}
+
+void SVFilter :: setCoefficients( StkFloat frequency, StkFloat q, bool clearState )
+{
+  this->setQ( q );
+  this->setCutoff( frequency );
+
+  if ( clearState ) this->clear();
+}
+
+void SVFilter :: setMix( void )
+{
+  // output = m0 * input + m1 * band + m2 * low
+  switch ( type_ ) {
+  case BANDPASS:
+    m0_ = 0.0; m1_ = k_; m2_ = 0.0;
+    break;
+  case HIGHPASS:
+    m0_ = 1.0; m1_ = -k_; m2_ = -1.0;
+    break;
+  case NOTCH:
+    m0_ = 1.0; m1_ = -k_; m2_ = 0.0;
+    break;
+  case LOWPASS:
+  default:
+    m0_ = 0.0; m1_ = 0.0; m2_ = 1.0;
+    break;
+  }
+}
+
+} // stk namespace
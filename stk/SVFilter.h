@@ -0,0 +1,194 @@
+#ifndef STK_SVFILTER_H
+#define STK_SVFILTER_H
+
+#include "Filter.h"
+
+namespace stk {
+
+/***************************************************/
+/*! \class SVFilter
+    \brief STK state-variable filter class.
+
+    This class implements a two-pole state-variable filter in its
+    trapezoidal (zero-delay feedback) form, with lowpass, bandpass,
+    highpass and notch responses.  The state holds the integrator
+    charges rather than past outputs, so the cutoff can be changed
+    every sample without the transients a direct-form biquad produces
+    under modulation.
+
+    The cutoff prewarp uses a rational approximation of tan() instead
+    of the library call, cheap enough to run per sample.
+*/
+/***************************************************/
+
+class SVFilter : public Filter
+{
+public:
+
+  //! Filter responses.
+  enum {
+    LOWPASS,   /*!< Lowpass */
+    BANDPASS,  /*!< Bandpass, unity gain at the cutoff */
+    HIGHPASS,  /*!< Highpass */
+    NOTCH      /*!< Notch (band reject) */
+  };
+
+  //! Default constructor creates a 1 kHz lowpass filter with Q = 0.707.
+  SVFilter( void );
+
+  //! Class destructor.
+  ~SVFilter( void );
+
+  //! Clears the internal state of the filter.
+  void clear( void );
+
+  //! Set the filter response (LOWPASS, BANDPASS, HIGHPASS or NOTCH).
+  void setType( int type );
+
+  //! Set the cutoff (or center) frequency in Hz.
+  /*!
+    Frequencies are clamped just below half the sample rate.
+  */
+  void setCutoff( StkFloat frequency );
+
+  //! Set the resonance as a Q value (0.5 is critically damped, must be positive).
+  void setQ( StkFloat q );
+
+  //! Set the damping directly (k = 1 / Q, must be positive).
+  void setDamping( StkFloat damping );
+
+  //! Set the cutoff frequency and Q at once.
+  void setCoefficients( StkFloat frequency, StkFloat q, bool clearState = false );
+
+  //! Return the prewarped integrator gain tan( PI * frequency / sampleRate ).
+  /*!
+    A 7/6 Pade approximation of tan() is used, with a relative error
+    below 7e-8 up to 0.49 fs (and below 4e-9 up to 0.45 fs).
+    Frequencies are clamped to [0, 0.49 fs].
+  */
+  static StkFloat prewarp( StkFloat frequency, StkFloat sampleRate );
+
+  //! Return the last computed output value.
+  StkFloat lastOut( void ) const { return lastFrame_[0]; };
+
+  //! Input one sample to the filter and return one output.
+  StkFloat tick( StkFloat input );
+
+  //! Input one sample to the filter with a new cutoff frequency (Hz) and return one output.
+  StkFloat tick( StkFloat input, StkFloat frequency );
+
+  //! Take a channel of the StkFrames object as inputs to the filter and replace with corresponding outputs.
+  /*!
+    The StkFrames argument reference is returned.  The \c channel
+    argument must be less than the number of channels in the
+    StkFrames argument (the first channel is specified by 0).
+    However, range checking is only performed if _STK_DEBUG_ is
+    defined during compilation, in which case an out-of-range value
+    will trigger an StkError exception.
+  */
+  StkFrames& tick( StkFrames& frames, unsigned int channel = 0 );
+
+  //! Filter a channel of the StkFrames object with the cutoff taken per sample from the first channel of \c frequencies (Hz).
+  /*!
+    The StkFrames argument reference is returned.  The \c
+    frequencies argument must have at least as many frames as \c
+    frames.  Range checking is only performed if _STK_DEBUG_ is
+    defined during compilation, in which case an out-of-range value
+    will trigger an StkError exception.
+  */
+  StkFrames& tick( StkFrames& frames, const StkFrames& frequencies, unsigned int channel = 0 );
+
+protected:
+
+  void sampleRateChanged( StkFloat newRate, StkFloat oldRate );
+  void setIntegratorGain( StkFloat g );
+  void setMix( void );
+
+  int type_;
+  StkFloat frequency_;
+  StkFloat k_;
+  StkFloat a1_;
+  StkFloat a2_;
+  StkFloat a3_;
+  StkFloat m0_;
+  StkFloat m1_;
+  StkFloat m2_;
+  StkFloat ic1eq_;
+  StkFloat ic2eq_;
+};
+
+inline StkFloat SVFilter :: prewarp( StkFloat frequency, StkFloat sampleRate )
+{
+  StkFloat x = PI * frequency / sampleRate;
+  if ( x < 0.0 ) x = 0.0;
+  if ( x > 0.49 * PI ) x = 0.49 * PI;
+
+  StkFloat x2 = x * x;
+  return x * ( 135135.0 - x2 * ( 17325.0 - x2 * ( 378.0 - x2 ) ) ) /
+    ( 135135.0 - x2 * ( 62370.0 - x2 * ( 3150.0 - 28.0 * x2 ) ) );
+}
+
+inline void SVFilter :: setIntegratorGain( StkFloat g )
+{
+  a1_ = 1.0 / ( 1.0 + g * ( g + k_ ) );
+  a2_ = g * a1_;
+  a3_ = g * a2_;
+}
+
+inline StkFloat SVFilter :: tick( StkFloat input )
+{
+  StkFloat v0 = gain_ * input;
+  StkFloat v3 = v0 - ic2eq_;
+  StkFloat v1 = a1_ * ic1eq_ + a2_ * v3;
+  StkFloat v2 = ic2eq_ + a2_ * ic1eq_ + a3_ * v3;
+  ic1eq_ = undenormalize( 2.0 * v1 - ic1eq_ );
+  ic2eq_ = undenormalize( 2.0 * v2 - ic2eq_ );
+
+  lastFrame_[0] = m0_ * v0 + m1_ * v1 + m2_ * v2;
+  return lastFrame_[0];
+}
+
+inline StkFloat SVFilter :: tick( StkFloat input, StkFloat frequency )
+{
+  frequency_ = frequency;
+  this->setIntegratorGain( prewarp( frequency, context_->sampleRate() ) );
+  return this->tick( input );
+}
+
+inline StkFrames& SVFilter :: tick( StkFrames& frames, unsigned int channel )
+{
+#if defined(_STK_DEBUG_)
+  if ( channel >= frames.channels() ) {
+    oStream_ << "SVFilter::tick(): channel and StkFrames arguments are incompatible!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  StkFloat *samples = &frames[channel];
+  unsigned int hop = frames.channels();
+  for ( unsigned int i=0; i<frames.frames(); i++, samples += hop )
+    *samples = this->tick( *samples );
+
+  return frames;
+}
+
+inline StkFrames& SVFilter :: tick( StkFrames& frames, const StkFrames& frequencies, unsigned int channel )
+{
+#if defined(_STK_DEBUG_)
+  if ( channel >= frames.channels() || frequencies.frames() < frames.frames() ) {
+    oStream_ << "SVFilter::tick(): channel and StkFrames arguments are incompatible!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  StkFloat *samples = &frames[channel];
+  unsigned int hop = frames.channels();
+  for ( unsigned int i=0; i<frames.frames(); i++, samples += hop )
+    *samples = this->tick( *samples, frequencies( i, 0 ) );
+
+  return frames;
+}
+
+} // stk namespace
+
+#endif
@@ -14,6 +14,7 @@
 /***************************************************/
 
 #include "SineWave.h"
+#include "StkArena.h"
 #include <cmath>
 
 namespace stk {
@@ -24,7 +25,11 @@ SineWave :: SineWave( void )
   : time_(0.0), rate_(1.0), phaseOffset_(0.0)
 {
   if ( table_.empty() ) {
+    // The table outlives any arena it might be built in, so keep it on the heap.
+    StkArena *arena = StkArena::current();
+    StkArena::setCurrent( 0 );
     table_.resize( TABLE_SIZE + 1, 1 );
+    StkArena::setCurrent( arena );
     StkFloat temp = 1.0 / TABLE_SIZE;
     for ( unsigned long i=0; i<=TABLE_SIZE; i++ )
       table_[i] = sin( TWO_PI * i * temp );
@@ -53,7 +58,7 @@ void SineWave :: reset( void )
 void SineWave :: setFrequency( StkFloat frequency )
 {
   // This is a looping frequency.
-  this->setRate( TABLE_SIZE * frequency / Stk::sampleRate() );
+  this->setRate( TABLE_SIZE * frequency / context_->sampleRate() );
 }
 
 void SineWave :: addTime( StkFloat time )
@@ -51,11 +51,18 @@
 /***************************************************/
 
 #include "Stk.h"
+#include "StkArena.h"
 #include <stdlib.h>
+#if defined(__OS_WINDOWS__)
+  #include <malloc.h>
+#endif
+
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+  #include <xmmintrin.h>
+#endif
 
 namespace stk {
 
-StkFloat Stk :: srate_ = (StkFloat) SRATE;
 std::string Stk :: rawwavepath_ = RAWWAVE_PATH;
 const Stk::StkFormat Stk :: STK_SINT8   = 0x1;
 const Stk::StkFormat Stk :: STK_SINT16  = 0x2;
@@ -65,11 +72,10 @@ const Stk::StkFormat Stk :: STK_FLOAT32 = 0x10;
 const Stk::StkFormat Stk :: STK_FLOAT64 = 0x20;
 bool Stk :: showWarnings_ = true;
 bool Stk :: printErrors_ = true;
-std::vector<Stk *> Stk :: alertList_;
-std::ostringstream Stk :: oStream_;
+thread_local std::ostringstream Stk :: oStream_;
 
 Stk :: Stk( void )
-  : ignoreSampleRateChange_(false)
+  : context_( StkContext::current() ), ignoreSampleRateChange_(false)
 {
 }
 
@@ -79,13 +85,12 @@ Stk :: ~Stk( void )
 
 void Stk :: setSampleRate( StkFloat rate )
 {
-  if ( rate > 0.0 && rate != srate_ ) {
-    StkFloat oldRate = srate_;
-    srate_ = rate;
+  StkContext::current()->setSampleRate( rate );
+}
 
-    for ( unsigned int i=0; i<alertList_.size(); i++ )
-      alertList_[i]->sampleRateChanged( srate_, oldRate );
-  }
+void Stk :: clear_alertList()
+{
+  StkContext::current()->clearSampleRateAlerts();
 }
 
 void Stk :: sampleRateChanged( StkFloat /*newRate*/, StkFloat /*oldRate*/ )
@@ -96,6 +101,51 @@ void Stk :: sampleRateChanged( StkFloat /*newRate*/, StkFloat /*oldRate*/ )
 }
 
 void Stk :: addSampleRateAlert( Stk *ptr )
+{
+  ptr->context_->addSampleRateAlert( ptr );
+}
+
+void Stk :: removeSampleRateAlert( Stk *ptr )
+{
+  ptr->context_->removeSampleRateAlert( ptr );
+}
+
+//
+// StkContext definitions
+//
+
+thread_local StkContext *StkContext :: current_ = 0;
+
+StkContext :: StkContext( StkFloat sampleRate, unsigned int blockSize )
+  : sampleRate_( sampleRate ), blockSize_( blockSize )
+{
+}
+
+StkContext :: ~StkContext( void )
+{
+  if ( current_ == this ) current_ = 0;
+}
+
+StkContext& StkContext :: defaultContext( void )
+{
+  // never destroyed, so objects with static storage can still
+  // unsubscribe from it at exit
+  static StkContext *context = new StkContext();
+  return *context;
+}
+
+void StkContext :: setSampleRate( StkFloat rate )
+{
+  if ( rate > 0.0 && rate != sampleRate_ ) {
+    StkFloat oldRate = sampleRate_;
+    sampleRate_ = rate;
+
+    for ( unsigned int i=0; i<alertList_.size(); i++ )
+      alertList_[i]->sampleRateChanged( sampleRate_, oldRate );
+  }
+}
+
+void StkContext :: addSampleRateAlert( Stk *ptr )
 {
   for ( unsigned int i=0; i<alertList_.size(); i++ )
     if ( alertList_[i] == ptr ) return;
@@ -103,7 +153,7 @@ void Stk :: addSampleRateAlert( Stk *ptr )
   alertList_.push_back( ptr );
 }
 
-void Stk :: removeSampleRateAlert( Stk *ptr )
+void StkContext :: removeSampleRateAlert( Stk *ptr )
 {
   for ( unsigned int i=0; i<alertList_.size(); i++ ) {
     if ( alertList_[i] == ptr ) {
@@ -192,6 +242,33 @@ void Stk :: sleep(unsigned long milliseconds)
 #endif
 }
 
+void Stk :: setDenormalFlush( bool flush )
+{
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+  // MXCSR bit 15 is flush-to-zero, bit 6 is denormals-are-zero.
+  unsigned int csr = _mm_getcsr();
+  if ( flush ) csr |= 0x8040;
+  else csr &= ~0x8040;
+  _mm_setcsr( csr );
+#elif defined(__aarch64__)
+  // FPCR bit 24 is flush-to-zero.
+  unsigned long fpcr;
+  __asm__ __volatile__ ( "mrs %0, fpcr" : "=r" ( fpcr ) );
+  if ( flush ) fpcr |= ( 1UL << 24 );
+  else fpcr &= ~( 1UL << 24 );
+  __asm__ __volatile__ ( "msr fpcr, %0" : : "r" ( fpcr ) );
+#elif defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__)
+  // FPSCR bit 24 is flush-to-zero.
+  unsigned int fpscr;
+  __asm__ __volatile__ ( "vmrs %0, fpscr" : "=r" ( fpscr ) );
+  if ( flush ) fpscr |= ( 1U << 24 );
+  else fpscr &= ~( 1U << 24 );
+  __asm__ __volatile__ ( "vmsr fpscr, %0" : : "r" ( fpscr ) );
+#else
+  (void) flush;
+#endif
+}
+
 void Stk :: handleError( StkError::Type type ) const
 {
   handleError( oStream_.str(), type );
@@ -228,14 +305,47 @@ void Stk :: handleError( std::string message, StkError::Type type )
 // StkFrames definitions
 //
 
+// Frame data comes from the current arena when there is one (see
+// StkArena), otherwise from the heap.  Either way it starts on a 64-byte
+// boundary, a cache line and a whole number of SIMD registers (see
+// StkSimd).  Arena memory is released with its arena, never here.
+static StkFloat *allocateFrames( size_t size, bool zero )
+{
+  size_t bytes = size * sizeof( StkFloat );
+  StkArena *arena = StkArena::current();
+  if ( arena ) {
+    void *data = arena->allocate( bytes, StkFrames::ALIGNMENT );
+    if ( data ) return (StkFloat *) data;
+  }
+
+  void *data;
+#if defined(__OS_WINDOWS__)
+  data = _aligned_malloc( bytes, StkFrames::ALIGNMENT );
+#else
+  if ( posix_memalign( &data, StkFrames::ALIGNMENT, bytes ) != 0 ) data = NULL;
+#endif
+  if ( data && zero ) memset( data, 0, bytes );
+  return (StkFloat *) data;
+}
+
+static void releaseFrames( StkFloat *data )
+{
+  if ( data == NULL || StkArena::isArenaMemory( data ) ) return;
+#if defined(__OS_WINDOWS__)
+  _aligned_free( data );
+#else
+  free( data );
+#endif
+}
+
 StkFrames :: StkFrames( unsigned int nFrames, unsigned int nChannels )
-  : data_( 0 ), nFrames_( nFrames ), nChannels_( nChannels )
+  : data_( 0 ), nFrames_( nFrames ), nChannels_( nChannels ), ownsData_( true )
 {
   size_ = nFrames_ * nChannels_;
   bufferSize_ = size_;
 
   if ( size_ > 0 ) {
-    data_ = (StkFloat *) calloc( size_, sizeof( StkFloat ) );
+    data_ = allocateFrames( size_, true );
 #if defined(_STK_DEBUG_)
     if ( data_ == NULL ) {
       std::string error = "StkFrames: memory allocation error in constructor!";
@@ -248,12 +358,12 @@ StkFrames :: StkFrames( unsigned int nFrames, unsigned int nChannels )
 }
 
 StkFrames :: StkFrames( const StkFloat& value, unsigned int nFrames, unsigned int nChannels )
-  : data_( 0 ), nFrames_( nFrames ), nChannels_( nChannels )
+  : data_( 0 ), nFrames_( nFrames ), nChannels_( nChannels ), ownsData_( true )
 {
   size_ = nFrames_ * nChannels_;
   bufferSize_ = size_;
   if ( size_ > 0 ) {
-    data_ = (StkFloat *) malloc( size_ * sizeof( StkFloat ) );
+    data_ = allocateFrames( size_, false );
 #if defined(_STK_DEBUG_)
     if ( data_ == NULL ) {
       std::string error = "StkFrames: memory allocation error in constructor!";
@@ -268,11 +378,20 @@ StkFrames :: StkFrames( const StkFloat& value, unsigned int nFrames, unsigned in
 
 StkFrames :: ~StkFrames()
 {
-  if ( data_ ) free( data_ );
+  this->release();
+}
+
+void StkFrames :: release( void )
+{
+  if ( ownsData_ ) releaseFrames( data_ );
+  data_ = 0;
+  size_ = 0;
+  bufferSize_ = 0;
+  ownsData_ = true;
 }
 
 StkFrames :: StkFrames( const StkFrames& f )
-  : data_(0), size_(0), bufferSize_(0)
+  : data_(0), size_(0), bufferSize_(0), ownsData_( true )
 {
   resize( f.frames(), f.channels() );
   dataRate_ = Stk::sampleRate();
@@ -281,16 +400,56 @@ StkFrames :: StkFrames( const StkFrames& f )
 
 StkFrames& StkFrames :: operator= ( const StkFrames& f )
 {
-  if ( data_ ) free( data_ );
-  data_ = 0;
-  size_ = 0;
-  bufferSize_ = 0;
-  resize( f.frames(), f.channels() );
+  if ( this == &f ) return *this;
+
+  if ( ownsData_ ) {
+    this->release();
+    resize( f.frames(), f.channels() );
+  }
+  else if ( f.frames() * f.channels() != size_ ) {
+    Stk::handleError( "StkFrames::operator=: a view can only be assigned frames of its own size!",
+                      StkError::MEMORY_ACCESS );
+  }
+  else {
+    nFrames_ = f.frames();
+    nChannels_ = f.channels();
+  }
+
   dataRate_ = Stk::sampleRate();
   for ( unsigned int i=0; i<size_; i++ ) data_[i] = f[i];
   return *this;
 }
 
+#if __cplusplus >= 201103L
+StkFrames :: StkFrames( StkFrames&& f )
+  : data_( f.data_ ), dataRate_( f.dataRate_ ), nFrames_( f.nFrames_ ), nChannels_( f.nChannels_ ),
+    size_( f.size_ ), bufferSize_( f.bufferSize_ ), ownsData_( f.ownsData_ )
+{
+  f.data_ = 0;
+  f.release();
+  f.nFrames_ = 0;
+}
+
+StkFrames& StkFrames :: operator= ( StkFrames&& f )
+{
+  if ( this == &f ) return *this;
+
+  this->release();
+  data_ = f.data_;
+  dataRate_ = f.dataRate_;
+  nFrames_ = f.nFrames_;
+  nChannels_ = f.nChannels_;
+  size_ = f.size_;
+  bufferSize_ = f.bufferSize_;
+  ownsData_ = f.ownsData_;
+
+  f.data_ = 0;
+  f.release();
+  f.nFrames_ = 0;
+  return *this;
+}
+#endif
+
 void StkFrames :: resize( size_t nFrames, unsigned int nChannels )
 {
   nFrames_ = nFrames;
@@ -298,8 +457,12 @@ void StkFrames :: resize( size_t nFrames, unsigned int nChannels )
 
   size_ = nFrames_ * nChannels_;
   if ( size_ > bufferSize_ ) {
-    if ( data_ ) free( data_ );
-    data_ = (StkFloat *) malloc( size_ * sizeof( StkFloat ) );
+    if ( !ownsData_ ) {
+      Stk::handleError( "StkFrames::resize: a view can't grow beyond the frames it was given!",
+                        StkError::MEMORY_ALLOCATION );
+    }
+    releaseFrames( data_ );
+    data_ = allocateFrames( size_, false );
 #if defined(_STK_DEBUG_)
     if ( data_ == NULL ) {
       std::string error = "StkFrames::resize: memory allocation error!";
@@ -317,6 +480,49 @@ void StkFrames :: resize( size_t nFrames, unsigned int nChannels, StkFloat value
   for ( size_t i=0; i<size_; i++ ) data_[i] = value;
 }
     
+StkFramesView :: StkFramesView( StkFloat *data, unsigned int nFrames, unsigned int nChannels )
+  : StkFrames()
+{
+  data_ = data;
+  nFrames_ = nFrames;
+  nChannels_ = nChannels;
+  size_ = nFrames_ * nChannels_;
+  bufferSize_ = size_;
+  ownsData_ = false;
+}
+
+StkFramesView :: StkFramesView( StkFrames& frames, unsigned int offset, unsigned int nFrames )
+  : StkFrames()
+{
+#if defined(_STK_DEBUG_)
+  if ( offset + nFrames > frames.frames() ) {
+    std::ostringstream error;
+    error << "StkFramesView: frames " << offset << " to " << offset + nFrames << " are out of range!";
+    Stk::handleError( error.str(), StkError::MEMORY_ACCESS );
+  }
+#endif
+
+  data_ = frames.empty() ? 0 : &frames( offset, 0 );
+  nFrames_ = nFrames;
+  nChannels_ = frames.channels();
+  size_ = nFrames_ * nChannels_;
+  bufferSize_ = size_;
+  ownsData_ = false;
+  dataRate_ = frames.dataRate();
+}
+
+StkFramesView :: StkFramesView( const StkFramesView& view )
+  : StkFrames()
+{
+  data_ = view.data_;
+  nFrames_ = view.nFrames_;
+  nChannels_ = view.nChannels_;
+  size_ = view.size_;
+  bufferSize_ = view.bufferSize_;
+  ownsData_ = false;
+  dataRate_ = view.dataRate_;
+}
+
 StkFrames& StkFrames::getChannel(unsigned int sourceChannel,StkFrames& destinationFrames, unsigned int destinationChannel) const
 {
 #if defined(_STK_DEBUG_)
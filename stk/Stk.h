@@ -76,6 +76,13 @@ namespace stk {
 // a "long double" in the future.
 typedef double StkFloat;
 
+// A pair of StkFloat values processed as a single two-lane vector.
+// This is used for the left/right paths of the stereo effects so
+// that both channels are computed with one operation.  It relies on
+// the GCC / Clang vector extension, which maps onto SSE2 or NEON
+// registers where available and falls back to scalar code otherwise.
+typedef StkFloat StkFloat2 __attribute__ ((vector_size (2 * sizeof(StkFloat))));
+
 //! STK error handling class.
 /*!
   This is a fairly abstract exception handling class.  There could
@@ -129,6 +136,12 @@ public:
 };
 
 
+// Offset used by Stk::undenormalize() to round decaying feedback
+// values to zero long before they become denormal.
+const StkFloat DENORMAL_OFFSET = 1.0e-18;
+
+class StkContext;
+
 class Stk
 {
 public:
@@ -141,11 +154,17 @@ public:
   static const StkFormat STK_FLOAT32; /*!< Normalized between plus/minus 1.0. */
   static const StkFormat STK_FLOAT64; /*!< Normalized between plus/minus 1.0. */
 
-  //! Static method that returns the current STK sample rate.
-  static StkFloat sampleRate( void ) { return srate_; }
+  //! Static method that returns the sample rate of the calling thread's current StkContext.
+  /*!
+    This is the rate new objects will be built with.  An existing
+    object runs at the rate of its own context (see context()).
+  */
+  static StkFloat sampleRate( void );
 
-  //! Static method that sets the STK sample rate.
+  //! Static method that sets the sample rate of the calling thread's current StkContext.
   /*!
+    Unless a context has been made current (see StkContext), this
+    is the default context shared by every object built without one.
     The sample rate set using this method is queried by all STK
     classes that depend on its value.  It is initialized to the
     default SRATE set in Stk.h.  Many STK classes use the sample rate
@@ -172,8 +191,11 @@ public:
   */
   void ignoreSampleRateChange( bool ignore = true ) { ignoreSampleRateChange_ = ignore; };
   
-  //! Static method that frees memory from alertList_.
-  static void  clear_alertList(){std::vector<Stk *>().swap(alertList_);};
+  //! Static method that frees memory from the alert list of the calling thread's current StkContext.
+  static void  clear_alertList();
+
+  //! Return the context this object was built in, which supplies its sample rate.
+  StkContext *context( void ) const { return context_; };
   
   //! Static method that returns the current rawwave path.
   static std::string rawwavePath(void) { return rawwavepath_; }
@@ -200,6 +222,42 @@ public:
     else return true;
   }
 
+  //! Static method that enables or disables flushing of denormal floating-point values on the calling thread.
+  /*!
+    Recursive filters and reverb feedback paths decay toward zero
+    once their input stops, eventually producing denormal (subnormal)
+    values that are very slow to process on many CPUs.  When enabled,
+    this sets the flush-to-zero and denormals-are-zero modes (x86
+    SSE) or the flush-to-zero mode (ARM VFP / AArch64) of the floating
+    point unit.  The setting is per-thread, so it must be called from
+    the thread that runs the audio computation.  On other platforms
+    this function has no effect and undenormalize() should be relied
+    upon instead.
+  */
+  static void setDenormalFlush( bool flush = true );
+
+  //! Static method that rounds a denormal value to zero.
+  /*!
+    Adding and removing DENORMAL_OFFSET (1e-18) rounds values that are
+    much smaller than the offset to exactly zero.  It is not a no-op
+    for other values: each of the two steps can round, so values far
+    above the offset may move by a unit or two in the last place, and
+    values within a few orders of magnitude of it lose relative
+    precision too.  It is used in feedback paths so that decaying
+    tails do not become denormal on platforms where setDenormalFlush()
+    is unavailable.
+  */
+  static StkFloat undenormalize( StkFloat value ) {
+    value += DENORMAL_OFFSET;
+    return value - DENORMAL_OFFSET;
+  }
+
+  //! Static method that rounds denormal values to zero in both lanes of a two-lane vector.
+  static StkFloat2 undenormalize( StkFloat2 value ) {
+    value += DENORMAL_OFFSET;
+    return value - DENORMAL_OFFSET;
+  }
+
   //! Static function for error reporting and handling using c-strings.
   static void handleError( const char *message, StkError::Type type );
 
@@ -213,15 +271,16 @@ public:
   static void printErrors( bool status ) { printErrors_ = status; }
 
 private:
-  static StkFloat srate_;
   static std::string rawwavepath_;
   static bool showWarnings_;
   static bool printErrors_;
-  static std::vector<Stk *> alertList_;
 
 protected:
 
-  static std::ostringstream oStream_;
+  // one message stream per thread, so objects on different threads
+  // can report errors at the same time
+  static thread_local std::ostringstream oStream_;
+  StkContext *context_;
   bool ignoreSampleRateChange_;
 
   //! Default constructor.
@@ -232,6 +291,7 @@ protected:
 
   //! This function should be implemented in subclasses that depend on the sample rate.
   virtual void sampleRateChanged( StkFloat newRate, StkFloat oldRate );
+  friend class StkContext;
 
   //! Add class pointer to list for sample rate change notification.
   void addSampleRateAlert( Stk *ptr );
@@ -265,6 +325,9 @@ protected:
     Note that this class can also be used as a table with interpolating
     lookup.
 
+    The data is aligned to ALIGNMENT bytes.  While an StkArena is
+    current, it is allocated from the arena and must not outlive it.
+
     Possible future improvements in this class could include functions
     to convert to and return other data types.
 
@@ -276,6 +339,9 @@ class StkFrames
 {
 public:
 
+  //! Alignment (in bytes) of the frame data.
+  static const size_t ALIGNMENT = 64;
+
   //! The default constructor initializes the frame data structure to size zero.
   StkFrames( unsigned int nFrames = 0, unsigned int nChannels = 0 );
 
@@ -289,8 +355,20 @@ public:
   StkFrames( const StkFrames& f );
 
   // Assignment operator that returns a reference to self.
+  /*!
+    A view (see StkFramesView) keeps viewing the same memory and
+    copies the data of \c f into it, which must be the same size.
+  */
   StkFrames& operator= ( const StkFrames& f );
 
+#if __cplusplus >= 201103L
+  //! Move constructor, takes over the data of \c f and leaves it empty.
+  StkFrames( StkFrames&& f );
+
+  //! Move assignment, releases the current data and takes over the data of \c f.
+  StkFrames& operator= ( StkFrames&& f );
+#endif
+
   //! Subscript operator that returns a reference to element \c n of self.
   /*!
     The result can be used as an lvalue. This reference is valid
@@ -403,6 +481,12 @@ public:
   //! Return the number of channels represented by the data.
   unsigned int channels( void ) const { return nChannels_; };
 
+  //! Return a pointer to the first sample, for read-only access to const frames.
+  const StkFloat *data( void ) const { return data_; };
+
+  //! Return true if the data is owned (and released) by self rather than viewed.
+  bool ownsData( void ) const { return ownsData_; };
+
   //! Return the number of sample frames represented by the data.
   unsigned int frames( void ) const { return (unsigned int)nFrames_; };
 
@@ -420,7 +504,9 @@ public:
    */
   StkFloat dataRate( void ) const { return dataRate_; };
 
-private:
+protected:
+
+  void release( void );
 
   StkFloat *data_;
   StkFloat dataRate_;
@@ -428,9 +514,48 @@ private:
   unsigned int nChannels_;
   size_t size_;
   size_t bufferSize_;
+  bool ownsData_;
 
 };
 
+/***************************************************/
+/*! \class StkFramesView
+    \brief A non-owning StkFrames over memory held elsewhere.
+
+    A view presents a block of interleaved samples it doesn't own,
+    such as an RtAudio output buffer or a range of frames of another
+    StkFrames, as an StkFrames.  It can be passed to any tick()
+    function taking StkFrames, so stages process the memory in place
+    with no copies.  The memory must outlive the view, which never
+    allocates or frees it.
+
+    The samples of a frame are adjacent and frames are channels()
+    samples apart.  A single channel of an interleaved buffer is
+    reached the usual way, through the \c channel argument of the
+    tick() functions.
+
+    A view can be resized within the frames it was given, but not
+    beyond them.
+*/
+/***************************************************/
+
+class StkFramesView : public StkFrames
+{
+public:
+
+  //! View \c nFrames frames of \c nChannels interleaved channels starting at \c data.
+  StkFramesView( StkFloat *data, unsigned int nFrames, unsigned int nChannels );
+
+  //! View \c nFrames frames of \c frames, starting at frame \c offset.
+  StkFramesView( StkFrames& frames, unsigned int offset, unsigned int nFrames );
+
+  //! A copy views the same memory.
+  StkFramesView( const StkFramesView& view );
+
+  //! Assignment copies the data of \c f into the viewed memory.
+  StkFramesView& operator= ( const StkFrames& f ) { StkFrames::operator=( f ); return *this; };
+};
+
 inline bool StkFrames :: empty() const
 {
   if ( size_ > 0 ) return false;
@@ -574,6 +699,81 @@ const StkFloat PI           = 3.14159265358979;
 const StkFloat TWO_PI       = 2 * PI;
 const StkFloat ONE_OVER_128 = 0.0078125;
 
+/***************************************************/
+/*! \class StkContext
+    \brief STK processing context class.
+
+    A context carries what used to be process-wide STK state: the
+    sample rate, the block size and the list of objects to notify when
+    the sample rate changes.  Every Stk object belongs to the context
+    that was current on its thread when it was constructed, and takes
+    its sample rate from there.
+
+    Engines running at different rates in one process, or offline
+    renders on several threads, each create a context and make it
+    current while building their objects.  Changing a context's sample
+    rate notifies only the objects built in it.  Objects built while
+    no context is current use a default context, which the static
+    Stk::sampleRate() and Stk::setSampleRate() functions act on.
+
+    A context must outlive the objects built in it.
+*/
+/***************************************************/
+
+class StkContext
+{
+ public:
+
+  //! Create a context running at \c sampleRate, processing blocks of up to \c blockSize frames.
+  StkContext( StkFloat sampleRate = SRATE, unsigned int blockSize = RT_BUFFER_SIZE );
+
+  //! Class destructor.
+  ~StkContext( void );
+
+  //! Return the sample rate.
+  StkFloat sampleRate( void ) const { return sampleRate_; };
+
+  //! Set the sample rate and notify the objects built in this context.
+  void setSampleRate( StkFloat rate );
+
+  //! Return the largest block (in frames) the context's engine processes at once.
+  unsigned int blockSize( void ) const { return blockSize_; };
+
+  //! Set the block size.  Engines read it when they are built.
+  void setBlockSize( unsigned int blockSize ) { blockSize_ = blockSize; };
+
+  //! Add an object to be notified when the sample rate changes.
+  void addSampleRateAlert( Stk *ptr );
+
+  //! Remove an object from the sample rate notifications.
+  void removeSampleRateAlert( Stk *ptr );
+
+  //! Forget every object to be notified, and free the list.
+  void clearSampleRateAlerts( void ) { std::vector<Stk *>().swap( alertList_ ); };
+
+  //! Return the calling thread's current context, or the default context if none is set.
+  static StkContext *current( void ) { return current_ ? current_ : &defaultContext(); };
+
+  //! Make \c context current on the calling thread (NULL restores the default context).
+  static void setCurrent( StkContext *context ) { current_ = context; };
+
+  //! Return the default context.
+  static StkContext& defaultContext( void );
+
+ protected:
+
+  StkFloat sampleRate_;
+  unsigned int blockSize_;
+  std::vector<Stk *> alertList_;
+
+  static thread_local StkContext *current_;
+};
+
+inline StkFloat Stk :: sampleRate( void )
+{
+  return StkContext::current()->sampleRate();
+}
+
 #if defined(__WINDOWS_DS__) || defined(__WINDOWS_ASIO__) || defined(__WINDOWS_MM__)
   #define __OS_WINDOWS__
   #define __STK_REALTIME__
@@ -0,0 +1,155 @@
+/***************************************************/
+/*! \class StkArena
+    \brief STK contiguous memory arena class.
+
+    See StkArena.h for how the arena hands out and releases memory.
+*/
+/***************************************************/
+
+#include "StkArena.h"
+#include <cstdlib>
+#include <mutex>
+
+#if !defined(__OS_WINDOWS__)
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+namespace stk {
+
+thread_local StkArena *StkArena :: current_ = 0;
+StkArena *StkArena :: arenas_ = 0;
+
+// guards arenas_, since arenas may be created on several threads
+static std::mutex arenasMutex;
+
+StkArena :: StkArena( size_t size, bool hugePages, bool lock )
+  : base_( 0 ), size_( 0 ), used_( 0 ), hugePages_( false ), locked_( false ), records_( 0 )
+{
+#if defined(__OS_WINDOWS__)
+  base_ = (char *) calloc( size, 1 );
+  if ( base_ ) size_ = size;
+  if ( hugePages || lock ) {
+    oStream_ << "StkArena::StkArena: huge pages and locking are not supported on this platform!";
+    handleError( StkError::WARNING );
+  }
+#else
+  size_t pageSize = (size_t) sysconf( _SC_PAGESIZE );
+  size = ( size + pageSize - 1 ) / pageSize * pageSize;
+
+#if defined(MAP_HUGETLB)
+  if ( hugePages ) {
+    // explicit huge pages are 2 MB here, and must be reserved by the system
+    size_t hugeSize = ( size + ( 1 << 21 ) - 1 ) >> 21 << 21;
+    void *memory = mmap( 0, hugeSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+    if ( memory != MAP_FAILED ) {
+      base_ = (char *) memory;
+      size_ = hugeSize;
+      hugePages_ = true;
+    }
+  }
+#endif
+
+  if ( base_ == 0 ) {
+    void *memory = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( memory != MAP_FAILED ) {
+      base_ = (char *) memory;
+      size_ = size;
+#if defined(MADV_HUGEPAGE)
+      // otherwise ask for transparent huge pages
+      if ( hugePages && madvise( base_, size_, MADV_HUGEPAGE ) == 0 )
+        hugePages_ = true;
+#endif
+    }
+  }
+
+  if ( base_ && lock ) {
+    if ( mlock( base_, size_ ) == 0 )
+      locked_ = true;
+    else {
+      oStream_ << "StkArena::StkArena: unable to lock " << size_ << " bytes into memory!";
+      handleError( StkError::WARNING );
+      // still take the page faults now rather than in the audio thread
+      for ( size_t i=0; i<size_; i+=pageSize ) base_[i] = 0;
+    }
+  }
+#endif
+
+  if ( base_ == 0 ) {
+    oStream_ << "StkArena::StkArena: unable to reserve " << size << " bytes, using the heap!";
+    handleError( StkError::WARNING );
+  }
+
+  std::lock_guard<std::mutex> guard( arenasMutex );
+  nextArena_ = arenas_;
+  arenas_ = this;
+}
+
+StkArena :: ~StkArena()
+{
+  while ( records_ ) {
+    Record *record = records_;
+    records_ = record->next;
+    record->destroy( record->object );
+  }
+
+  if ( current_ == this ) current_ = 0;
+  {
+    std::lock_guard<std::mutex> guard( arenasMutex );
+    StkArena **link = &arenas_;
+    while ( *link != this ) link = &(*link)->nextArena_;
+    *link = nextArena_;
+  }
+
+  if ( base_ == 0 ) return;
+#if defined(__OS_WINDOWS__)
+  free( base_ );
+#else
+  if ( locked_ ) munlock( base_, size_ );
+  munmap( base_, size_ );
+#endif
+}
+
+void *StkArena :: allocate( size_t size, size_t alignment )
+{
+  size_t start = ( used_ + alignment - 1 ) & ~( alignment - 1 );
+  if ( base_ == 0 || start + size > size_ ) return NULL;
+
+  used_ = start + size;
+  return base_ + start;
+}
+
+void *StkArena :: reserve( size_t size, Record **record )
+{
+  size_t used = used_;
+  *record = (Record *) this->allocate( sizeof( Record ), sizeof( void * ) );
+  void *memory = this->allocate( size );
+  if ( *record == NULL || memory == NULL ) {
+    used_ = used;
+    return NULL;
+  }
+
+  return memory;
+}
+
+void StkArena :: commit( Record *record, void *object, void (*destroy)( void * ) )
+{
+  // records are added once construction has finished, so an object is
+  // destroyed before anything it created in the arena
+  record->object = object;
+  record->destroy = destroy;
+  record->next = records_;
+  records_ = record;
+}
+
+bool StkArena :: isArenaMemory( const void *pointer )
+{
+  std::lock_guard<std::mutex> guard( arenasMutex );
+  for ( StkArena *arena = arenas_; arena; arena = arena->nextArena_ )
+    if ( arena->owns( pointer ) ) return true;
+
+  return false;
+}
+
+} // stk namespace
@@ -0,0 +1,151 @@
+#ifndef STK_STKARENA_H
+#define STK_STKARENA_H
+
+#include "Stk.h"
+#include <new>
+
+namespace stk {
+
+/***************************************************/
+/*! \class StkArena
+    \brief STK contiguous memory arena class.
+
+    This class reserves one block of memory up front and hands it out
+    in cache-line aligned pieces, so objects built together (a voice,
+    its oscillators and their buffers) sit next to each other in
+    memory.  The block can be backed by huge pages and locked into RAM
+    so no page faults happen once audio is running.
+
+    While an arena is made current with setCurrent(), every StkFrames
+    allocation (the delay lines and tables inside STK objects) made on
+    that thread is taken from it.  Arena memory is never freed piece
+    by piece: it is released all at once when the arena is destroyed,
+    after the objects built with create() have been destroyed in
+    reverse order.  When the block is exhausted, allocations fall back
+    to the heap.
+*/
+/***************************************************/
+
+class StkArena : public Stk
+{
+ public:
+
+  //! Allocation granularity and alignment, the size of a cache line.
+  static const size_t ALIGNMENT = 64;
+
+  //! Reserve \c size bytes, optionally backed by huge pages and locked into memory.
+  /*!
+    Huge pages fall back to regular pages when the system has none
+    available.  If the memory can't be locked (usually because of
+    RLIMIT_MEMLOCK) a warning is reported and the pages are touched
+    instead, so they are at least faulted in before use.
+  */
+  StkArena( size_t size, bool hugePages = false, bool lock = false );
+
+  //! Destroys the objects built with create(), newest first, and releases the memory.
+  ~StkArena();
+
+  //! Return \c size bytes aligned to \c alignment (a power of two), or NULL when the arena is full.
+  /*!
+    The memory is zeroed.
+  */
+  void *allocate( size_t size, size_t alignment = ALIGNMENT );
+
+  //! Construct an object in the arena; it is destroyed with the arena.
+  /*!
+    When the arena is full the object is allocated with new instead
+    and is the caller's to delete (see isArenaMemory()).
+  */
+  template <class T> T *create( void );
+
+  //! Construct an object in the arena with one constructor argument.
+  template <class T, class A1> T *create( const A1& a1 );
+
+  //! Construct an object in the arena with two constructor arguments.
+  template <class T, class A1, class A2> T *create( const A1& a1, const A2& a2 );
+
+  //! Return true if \c pointer lies in this arena's memory.
+  bool owns( const void *pointer ) const { return (const char *) pointer >= base_ && (const char *) pointer < base_ + size_; };
+
+  //! Return the total number of bytes reserved.
+  size_t size( void ) const { return size_; };
+
+  //! Return the number of bytes handed out so far.
+  size_t used( void ) const { return used_; };
+
+  //! Return true if the memory is backed by huge pages.
+  bool hugePages( void ) const { return hugePages_; };
+
+  //! Return true if the memory is locked into RAM.
+  bool locked( void ) const { return locked_; };
+
+  //! Make \c arena the source of StkFrames allocations on the calling thread (NULL restores the heap).
+  static void setCurrent( StkArena *arena ) { current_ = arena; };
+
+  //! Return the arena StkFrames on the calling thread currently allocate from, or NULL.
+  static StkArena *current( void ) { return current_; };
+
+  //! Return true if \c pointer lies in any live arena.
+  static bool isArenaMemory( const void *pointer );
+
+ protected:
+
+  // One per object built with create(), kept newest first.
+  struct Record {
+    Record *next;
+    void (*destroy)( void *object );
+    void *object;
+  };
+
+  template <class T> static void destroyObject( void *object ) { static_cast<T *>( object )->~T(); };
+  void *reserve( size_t size, Record **record );
+  void commit( Record *record, void *object, void (*destroy)( void * ) );
+
+  char *base_;
+  size_t size_;
+  size_t used_;
+  bool hugePages_;
+  bool locked_;
+  Record *records_;
+  StkArena *nextArena_;
+
+  static thread_local StkArena *current_;
+  static StkArena *arenas_;
+};
+
+template <class T>
+T *StkArena :: create( void )
+{
+  Record *record;
+  void *memory = this->reserve( sizeof( T ), &record );
+  if ( memory == NULL ) return new T();
+  T *object = new ( memory ) T();
+  this->commit( record, object, &destroyObject<T> );
+  return object;
+}
+
+template <class T, class A1>
+T *StkArena :: create( const A1& a1 )
+{
+  Record *record;
+  void *memory = this->reserve( sizeof( T ), &record );
+  if ( memory == NULL ) return new T( a1 );
+  T *object = new ( memory ) T( a1 );
+  this->commit( record, object, &destroyObject<T> );
+  return object;
+}
+
+template <class T, class A1, class A2>
+T *StkArena :: create( const A1& a1, const A2& a2 )
+{
+  Record *record;
+  void *memory = this->reserve( sizeof( T ), &record );
+  if ( memory == NULL ) return new T( a1, a2 );
+  T *object = new ( memory ) T( a1, a2 );
+  this->commit( record, object, &destroyObject<T> );
+  return object;
+}
+
+} // stk namespace
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef STK_STKMATH_H
+#define STK_STKMATH_H
+
+#include "StkSimd.h"
+#include <cstring>
+
+namespace stk {
+
+/***************************************************/
+/*! \class StkMath
+    \brief STK fast transcendental functions.
+
+    Polynomial approximations of sin, cos, tan, exp2, log2 and pow for
+    code that calls them per sample, or per voice at control rate, and
+    can do without libm's last few bits.  Each reduces its argument
+    with a little bit twiddling and evaluates one short polynomial,
+    Chebyshev fitted over the reduced range, with no branches or
+    tables.  The same code works one StkFloat or four at once in a
+    StkFloat4 (see StkSimd), passed by reference, and block versions
+    work a buffer in place four samples at a time.
+
+    Maximum errors, measured against long double libm over the ranges
+    given:
+
+    - sin, cos: 3.4e-12 absolute, |x| < 1e6
+    - tan: 4.9e-12 relative, |x| < 1e6
+    - exp2: 1.1e-12 relative, exact at whole numbers, -1022 <= x <= 1023
+    - log2: 2.2e-12 absolute, any positive normal x
+    - pow: 1.1e-12 + 1.5e-12 * |y| relative, as exp2( y * log2( x ) ),
+      x positive and normal and the result in exp2's range
+
+    That's around 40 bits, ten million times finer than 16 bit
+    audio, and an interval error of about 2e-9 cents for exp2 tuning.
+    Outside their ranges the results are meaningless, and nothing
+    raises errors or sets errno.  Nothing calls these in place of
+    <cmath> unless it asks for StkMath:: by name.
+
+    The range reductions round with the 1.5 * 2^52 trick, so they need
+    IEEE double arithmetic (no -ffast-math, no x87).
+*/
+/***************************************************/
+
+// The bits of four StkFloats.
+typedef unsigned long long StkBits4 __attribute__ ((vector_size (4 * sizeof(unsigned long long))));
+
+class StkMath
+{
+ public:
+
+  //! Sine of \c x radians.
+  static StkFloat sin( StkFloat x ) { StkFloat y; sinQuadrant<StkFloat, unsigned long long>( x, 0, y ); return y; };
+
+  //! y = sin( x ) for four values (\c y may be \c x).
+  static void sin( const StkFloat4& x, StkFloat4& y ) { sinQuadrant<StkFloat4, StkBits4>( x, 0, y ); };
+
+  //! samples[i] = sin( samples[i] )
+  static void sin( StkFloat *samples, unsigned long n );
+
+  //! Cosine of \c x radians.
+  static StkFloat cos( StkFloat x ) { StkFloat y; sinQuadrant<StkFloat, unsigned long long>( x, 1, y ); return y; };
+
+  //! y = cos( x ) for four values (\c y may be \c x).
+  static void cos( const StkFloat4& x, StkFloat4& y ) { sinQuadrant<StkFloat4, StkBits4>( x, 1, y ); };
+
+  //! samples[i] = cos( samples[i] )
+  static void cos( StkFloat *samples, unsigned long n );
+
+  //! Tangent of \c x radians.
+  static StkFloat tan( StkFloat x ) { StkFloat y; tanKernel<StkFloat, unsigned long long>( x, y ); return y; };
+
+  //! y = tan( x ) for four values (\c y may be \c x).
+  static void tan( const StkFloat4& x, StkFloat4& y ) { tanKernel<StkFloat4, StkBits4>( x, y ); };
+
+  //! samples[i] = tan( samples[i] )
+  static void tan( StkFloat *samples, unsigned long n );
+
+  //! 2 to the power \c x.
+  static StkFloat exp2( StkFloat x ) { StkFloat y; exp2Kernel<StkFloat, unsigned long long>( x, y ); return y; };
+
+  //! y = 2 to the power \c x for four values (\c y may be \c x).
+  static void exp2( const StkFloat4& x, StkFloat4& y ) { exp2Kernel<StkFloat4, StkBits4>( x, y ); };
+
+  //! samples[i] = exp2( samples[i] )
+  static void exp2( StkFloat *samples, unsigned long n );
+
+  //! Base 2 logarithm of \c x.
+  static StkFloat log2( StkFloat x ) { StkFloat y; log2Kernel<StkFloat, unsigned long long>( x, y ); return y; };
+
+  //! y = log2( x ) for four values (\c y may be \c x).
+  static void log2( const StkFloat4& x, StkFloat4& y ) { log2Kernel<StkFloat4, StkBits4>( x, y ); };
+
+  //! samples[i] = log2( samples[i] )
+  static void log2( StkFloat *samples, unsigned long n );
+
+  //! \c x to the power \c y, for positive \c x.
+  static StkFloat pow( StkFloat x, StkFloat y ) { StkFloat z; powKernel<StkFloat, unsigned long long>( x, y, z ); return z; };
+
+  //! z = pow( x, y ) for four values (\c z may be \c x or \c y).
+  static void pow( const StkFloat4& x, const StkFloat4& y, StkFloat4& z ) { powKernel<StkFloat4, StkBits4>( x, y, z ); };
+
+  //! samples[i] = pow( samples[i], y )
+  static void pow( StkFloat *samples, StkFloat y, unsigned long n );
+
+ protected:
+
+  // The kernels work on one StkFloat (with its bits in an unsigned
+  // long long) or on four (with their bits in a StkBits4).  They take
+  // and return values by reference: a 32 byte vector passed by value
+  // is passed differently with and without AVX, and GCC warns
+  // (-Wpsabi) about every function that does it.
+  template <class T, class U> static void copyBits( const T& from, U& to ) { std::memcpy( &to, &from, sizeof(to) ); };
+
+  template <class F, class B> static void sinQuadrant( const F& x, unsigned int shift, F& y );
+  template <class F, class B> static void tanKernel( const F& x, F& y );
+  template <class F, class B> static void exp2Kernel( const F& x, F& y );
+  template <class F, class B> static void log2Kernel( const F& x, F& y );
+  template <class F, class B> static void powKernel( const F& x, const F& y, F& z );
+  template <class F> static void sinPolynomial( const F& r, const F& z, F& s );
+  template <class F> static void cosPolynomial( const F& z, F& c );
+};
+
+// Adding 1.5 * 2^52 rounds a double to the nearest integer, leaving
+// the integer in the low bits of its mantissa.
+#define STK_MATH_ROUNDER (6755399441055744.0)
+#define STK_MATH_ROUNDER_BITS (0x4338000000000000ULL)
+
+template <class F>
+inline void StkMath :: sinPolynomial( const F& r, const F& z, F& s )
+{
+  // sin( r ) for |r| <= PI / 4, z = r * r
+  s = r * ( 0.9999999999956727 + z * ( -0.16666666631589935 + z * ( 0.008333328782382004
+          + z * ( -0.00019839202195051091 + z * 2.7173455579772983e-06 ) ) ) );
+}
+
+template <class F>
+inline void StkMath :: cosPolynomial( const F& z, F& c )
+{
+  // cos( r ) for |r| <= PI / 4, z = r * r
+  c = 0.9999999999999445 + z * ( -0.499999999993532 + z * ( 0.041666666544183224
+      + z * ( -0.0013888880405915468 + z * ( 2.4798931022948063e-05 + z * -2.717358049995082e-07 ) ) ) );
+}
+
+template <class F, class B>
+inline void StkMath :: sinQuadrant( const F& x, unsigned int shift, F& y )
+{
+  // x = k * PI / 2 + r with |r| <= PI / 4.  PI / 2 is split in two so
+  // k times the first part is exact.
+  F t = x * 0.63661977236758134 + STK_MATH_ROUNDER;
+  F k = t - STK_MATH_ROUNDER;
+  F r = ( x - k * 1.57079632673412561417 ) - k * 6.07710050650619224932e-11;
+  F z = r * r;
+  F s, c;
+  sinPolynomial( r, z, s );
+  cosPolynomial( z, c );
+
+  // sin in even quadrants and cos in odd ones, negated in the lower
+  // two.  Cosine is sine a quadrant on.
+  unsigned long long quadrant = shift;
+  B q;
+  copyBits( t, q );
+  q += quadrant;
+  F v = ( q & 1 ) ? c : s;
+  y = ( q & 2 ) ? -v : v;
+}
+
+template <class F, class B>
+inline void StkMath :: tanKernel( const F& x, F& y )
+{
+  F t = x * 0.63661977236758134 + STK_MATH_ROUNDER;
+  F k = t - STK_MATH_ROUNDER;
+  F r = ( x - k * 1.57079632673412561417 ) - k * 6.07710050650619224932e-11;
+  F z = r * r;
+  F s, c;
+  sinPolynomial( r, z, s );
+  cosPolynomial( z, c );
+
+  // tan( r ) in even quadrants, -1 / tan( r ) in odd ones
+  B odd;
+  copyBits( t, odd );
+  odd &= 1;
+  F numerator = odd ? -c : s;
+  F denominator = odd ? s : c;
+  y = numerator / denominator;
+}
+
+template <class F, class B>
+inline void StkMath :: exp2Kernel( const F& x, F& y )
+{
+  // x = k + f with |f| <= 1 / 2, and 2^k is k's exponent field
+  F t = x + STK_MATH_ROUNDER;
+  F f = x - ( t - STK_MATH_ROUNDER );
+  F p = 1.0 + f * ( 0.6931471805459261 + f * ( 0.240226506958084
+        + f * ( 0.055504109412292654 + f * ( 0.00961812916050538 + f * ( 0.001333345054926364
+        + f * ( 0.00015403455068331418 + f * ( 1.531008375524026e-05 + f * 1.3255392130102134e-06 ) ) ) ) ) ) );
+  B k;
+  copyBits( t, k );
+  k = ( k - STK_MATH_ROUNDER_BITS + 1023 ) << 52;
+  F scale;
+  copyBits( k, scale );
+  y = p * scale;
+}
+
+template <class F, class B>
+inline void StkMath :: log2Kernel( const F& x, F& y )
+{
+  // x = 2^e * m with sqrt( 1 / 2 ) <= m < sqrt( 2 ).  Offsetting the
+  // bits by sqrt( 1 / 2 )'s carries the mantissas above sqrt( 2 ) into
+  // the exponent.
+  B u;
+  copyBits( x, u );
+  u += 0x3ff0000000000000ULL - 0x3fe6a09e667f3bcdULL;
+  B eBits = ( u >> 52 ) + STK_MATH_ROUNDER_BITS;
+  B mBits = ( u & 0x000fffffffffffffULL ) + 0x3fe6a09e667f3bcdULL;
+  F e, m;
+  copyBits( eBits, e );
+  copyBits( mBits, m );
+  e -= STK_MATH_ROUNDER + 1023.0;
+
+  // log2( m ) = 2 * atanh( t ) / ln( 2 ), t = ( m - 1 ) / ( m + 1 )
+  F t = ( m - 1.0 ) / ( m + 1.0 );
+  F z = t * t;
+  y = e + t * ( 2.885390081789979 + z * ( 0.961796673453689 + z * ( 0.5770835658106763
+              + z * ( 0.41167377320330895 + z * 0.34071195663729015 ) ) ) );
+}
+
+template <class F, class B>
+inline void StkMath :: powKernel( const F& x, const F& y, F& z )
+{
+  // exp2( y * log2( x ) )
+  F l;
+  log2Kernel<F, B>( x, l );
+  l *= y;
+  exp2Kernel<F, B>( l, z );
+}
+
+inline void StkMath :: sin( StkFloat *samples, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    StkFloat4& v = *(StkFloat4 *) ( samples + i );
+    sin( v, v );
+  }
+  for ( ; i < n; i++ )
+    samples[i] = sin( samples[i] );
+}
+
+inline void StkMath :: cos( StkFloat *samples, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    StkFloat4& v = *(StkFloat4 *) ( samples + i );
+    cos( v, v );
+  }
+  for ( ; i < n; i++ )
+    samples[i] = cos( samples[i] );
+}
+
+inline void StkMath :: tan( StkFloat *samples, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    StkFloat4& v = *(StkFloat4 *) ( samples + i );
+    tan( v, v );
+  }
+  for ( ; i < n; i++ )
+    samples[i] = tan( samples[i] );
+}
+
+inline void StkMath :: exp2( StkFloat *samples, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    StkFloat4& v = *(StkFloat4 *) ( samples + i );
+    exp2( v, v );
+  }
+  for ( ; i < n; i++ )
+    samples[i] = exp2( samples[i] );
+}
+
+inline void StkMath :: log2( StkFloat *samples, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    StkFloat4& v = *(StkFloat4 *) ( samples + i );
+    log2( v, v );
+  }
+  for ( ; i < n; i++ )
+    samples[i] = log2( samples[i] );
+}
+
+inline void StkMath :: pow( StkFloat *samples, StkFloat y, unsigned long n )
+{
+  StkFloat4 y4 = { y, y, y, y };
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    StkFloat4& v = *(StkFloat4 *) ( samples + i );
+    pow( v, y4, v );
+  }
+  for ( ; i < n; i++ )
+    samples[i] = pow( samples[i], y );
+}
+
+#undef STK_MATH_ROUNDER
+#undef STK_MATH_ROUNDER_BITS
+
+} // stk namespace
+
+#endif
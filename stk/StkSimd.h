@@ -0,0 +1,250 @@
+#ifndef STK_STKSIMD_H
+#define STK_STKSIMD_H
+
+#include "Stk.h"
+#include <cmath>
+
+namespace stk {
+
+/***************************************************/
+/*! \class StkSimd
+    \brief STK vector math kernels.
+
+    This class collects the block operations a render loop needs:
+    adding, scaling, mixing, crossfading, (de)interleaving and
+    measuring buffers.  Each works on a contiguous run of samples four
+    at a time, using the GCC / Clang vector extension (two SSE2 or NEON
+    operations, or one AVX operation when compiled for it).  Strided
+    versions cover single channels of interleaved StkFrames.
+
+    StkFrames data is allocated 64-byte aligned, so whole-buffer
+    kernels run on aligned memory.  The kernels don't require it, so
+    they also accept pointers into the middle of a buffer.
+
+    Kernels operate elementwise, so the output may be the same buffer
+    as one of the inputs.
+*/
+/***************************************************/
+
+// Four samples, loaded and stored without any alignment requirement.
+typedef StkFloat StkFloat4 __attribute__ ((vector_size (4 * sizeof(StkFloat)), aligned (sizeof(StkFloat))));
+
+class StkSimd
+{
+ public:
+
+  //! samples[i] += input[i]
+  static void add( StkFloat *samples, const StkFloat *input, unsigned long n );
+
+  //! samples[i] *= input[i]
+  static void multiply( StkFloat *samples, const StkFloat *input, unsigned long n );
+
+  //! samples[i] += gain * input[i]
+  static void multiplyAdd( StkFloat *samples, const StkFloat *input, StkFloat gain, unsigned long n );
+
+  //! samples[i] *= gain, every \c hop samples.
+  static void scale( StkFloat *samples, StkFloat gain, unsigned long n, unsigned int hop = 1 );
+
+  //! Scale every sample of \c frames.
+  static void scale( StkFrames& frames, StkFloat gain ) { scale( &frames[0], gain, frames.size() ); };
+
+  //! Scale one channel of \c frames.
+  static void scale( StkFrames& frames, StkFloat gain, unsigned int channel ) { scale( &frames[channel], gain, frames.frames(), frames.channels() ); };
+
+  //! output[i] = mix * wet[i] + ( 1 - mix ) * dry[i], with mix = start + ( i + 1 ) * step.
+  /*!
+    The mix ramps by \c step before each sample, the way a mix
+    parameter glides across a block.
+  */
+  static void crossfade( StkFloat *output, const StkFloat *dry, const StkFloat *wet,
+                         StkFloat start, StkFloat step, unsigned long n );
+
+  //! samples[i] += the sum of the \c nChannels interleaved channels of frame i of \c input.
+  static void mixDown( StkFloat *samples, const StkFloat *input, unsigned int nChannels, unsigned long n );
+
+  //! Interleave \c left and \c right into \c n stereo frames.
+  static void interleave( StkFloat *stereo, const StkFloat *left, const StkFloat *right, unsigned long n );
+
+  //! Split \c n stereo frames into \c left and \c right.
+  static void deinterleave( const StkFloat *stereo, StkFloat *left, StkFloat *right, unsigned long n );
+
+  //! Return the largest magnitude, every \c hop samples.
+  static StkFloat peak( const StkFloat *samples, unsigned long n, unsigned int hop = 1 );
+
+  //! Return the largest magnitude in one channel of \c frames.
+  static StkFloat peak( const StkFrames& frames, unsigned int channel ) { return frames.size() ? peak( frames.data() + channel, frames.frames(), frames.channels() ) : 0.0; };
+
+  //! Return the root-mean-square level, every \c hop samples.
+  static StkFloat rms( const StkFloat *samples, unsigned long n, unsigned int hop = 1 );
+
+  //! Return the root-mean-square level of one channel of \c frames.
+  static StkFloat rms( const StkFrames& frames, unsigned int channel ) { return frames.size() ? rms( frames.data() + channel, frames.frames(), frames.channels() ) : 0.0; };
+
+ protected:
+
+  // Four samples in place, read or written as one vector.  Vectors
+  // only cross function boundaries by reference: a 32 byte vector
+  // passed by value is passed differently with and without AVX, and
+  // GCC warns (-Wpsabi) about every function that does it.
+  static StkFloat4& vec( StkFloat *p ) { return *(StkFloat4 *) p; };
+  static const StkFloat4& vec( const StkFloat *p ) { return *(const StkFloat4 *) p; };
+};
+
+inline void StkSimd :: add( StkFloat *samples, const StkFloat *input, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 )
+    vec( samples + i ) += vec( input + i );
+  for ( ; i < n; i++ )
+    samples[i] += input[i];
+}
+
+inline void StkSimd :: multiply( StkFloat *samples, const StkFloat *input, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 )
+    vec( samples + i ) *= vec( input + i );
+  for ( ; i < n; i++ )
+    samples[i] *= input[i];
+}
+
+inline void StkSimd :: multiplyAdd( StkFloat *samples, const StkFloat *input, StkFloat gain, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 )
+    vec( samples + i ) += gain * vec( input + i );
+  for ( ; i < n; i++ )
+    samples[i] += gain * input[i];
+}
+
+inline void StkSimd :: scale( StkFloat *samples, StkFloat gain, unsigned long n, unsigned int hop )
+{
+  unsigned long i = 0;
+  if ( hop == 1 ) {
+    for ( ; i + 4 <= n; i += 4 )
+      vec( samples + i ) *= gain;
+  }
+  for ( ; i < n; i++ )
+    samples[i * hop] *= gain;
+}
+
+inline void StkSimd :: crossfade( StkFloat *output, const StkFloat *dry, const StkFloat *wet,
+                                  StkFloat start, StkFloat step, unsigned long n )
+{
+  unsigned long i = 0;
+  if ( step == 0.0 ) {
+    // a fixed mix
+    for ( ; i + 4 <= n; i += 4 ) {
+      StkFloat4 d = vec( dry + i );
+      vec( output + i ) = d + start * ( vec( wet + i ) - d );
+    }
+  }
+  else {
+    StkFloat4 mix = { start + step, start + 2 * step, start + 3 * step, start + 4 * step };
+    for ( ; i + 4 <= n; i += 4, mix += 4 * step ) {
+      StkFloat4 d = vec( dry + i );
+      vec( output + i ) = d + mix * ( vec( wet + i ) - d );
+    }
+  }
+
+  for ( ; i < n; i++ ) {
+    StkFloat mix = start + ( i + 1 ) * step;
+    output[i] = dry[i] + mix * ( wet[i] - dry[i] );
+  }
+}
+
+inline void StkSimd :: mixDown( StkFloat *samples, const StkFloat *input, unsigned int nChannels, unsigned long n )
+{
+  if ( nChannels == 1 ) {
+    add( samples, input, n );
+    return;
+  }
+
+  // four frames at a time, one lane per frame
+  unsigned long i = 0;
+  for ( ; i + 4 <= n; i += 4 ) {
+    const StkFloat *frame = input + i * nChannels;
+    StkFloat4 sum = vec( samples + i );
+    for ( unsigned int c = 0; c < nChannels; c++ ) {
+      StkFloat4 v = { frame[c], frame[nChannels + c], frame[2 * nChannels + c], frame[3 * nChannels + c] };
+      sum += v;
+    }
+    vec( samples + i ) = sum;
+  }
+  for ( ; i < n; i++ ) {
+    const StkFloat *frame = input + i * nChannels;
+    for ( unsigned int c = 0; c < nChannels; c++ )
+      samples[i] += frame[c];
+  }
+}
+
+inline void StkSimd :: interleave( StkFloat *stereo, const StkFloat *left, const StkFloat *right, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 2 <= n; i += 2 ) {
+    StkFloat4 v = { left[i], right[i], left[i + 1], right[i + 1] };
+    vec( stereo + 2 * i ) = v;
+  }
+  for ( ; i < n; i++ ) {
+    stereo[2 * i] = left[i];
+    stereo[2 * i + 1] = right[i];
+  }
+}
+
+inline void StkSimd :: deinterleave( const StkFloat *stereo, StkFloat *left, StkFloat *right, unsigned long n )
+{
+  unsigned long i = 0;
+  for ( ; i + 2 <= n; i += 2 ) {
+    StkFloat4 v = vec( stereo + 2 * i );
+    left[i] = v[0]; right[i] = v[1];
+    left[i + 1] = v[2]; right[i + 1] = v[3];
+  }
+  for ( ; i < n; i++ ) {
+    left[i] = stereo[2 * i];
+    right[i] = stereo[2 * i + 1];
+  }
+}
+
+inline StkFloat StkSimd :: peak( const StkFloat *samples, unsigned long n, unsigned int hop )
+{
+  StkFloat result = 0.0;
+  unsigned long i = 0;
+  if ( hop == 1 && n >= 4 ) {
+    StkFloat4 largest = { 0.0, 0.0, 0.0, 0.0 };
+    for ( ; i + 4 <= n; i += 4 ) {
+      StkFloat4 v = vec( samples + i );
+      v = v < 0.0 ? -v : v;
+      largest = v > largest ? v : largest;
+    }
+    for ( unsigned int lane = 0; lane < 4; lane++ )
+      if ( largest[lane] > result ) result = largest[lane];
+  }
+  for ( ; i < n; i++ ) {
+    StkFloat magnitude = fabs( samples[i * hop] );
+    if ( magnitude > result ) result = magnitude;
+  }
+  return result;
+}
+
+inline StkFloat StkSimd :: rms( const StkFloat *samples, unsigned long n, unsigned int hop )
+{
+  if ( n == 0 ) return 0.0;
+
+  StkFloat sum = 0.0;
+  unsigned long i = 0;
+  if ( hop == 1 ) {
+    StkFloat4 squares = { 0.0, 0.0, 0.0, 0.0 };
+    for ( ; i + 4 <= n; i += 4 ) {
+      StkFloat4 v = vec( samples + i );
+      squares += v * v;
+    }
+    sum = squares[0] + squares[1] + squares[2] + squares[3];
+  }
+  for ( ; i < n; i++ )
+    sum += samples[i * hop] * samples[i * hop];
+  return sqrt( sum / n );
+}
+
+} // stk namespace
+
+#endif
@@ -0,0 +1,22 @@
+# builds the test programs into tests/, run from the top of the tree
+g++ -std=c++11 -w -D__LITTLE_ENDIAN__ \
+	-Icore/ -Irtaudio/ -Istk/ -Ix-api/ \
+	-o tests/denormalBench \
+	tests/denormalBench.cpp \
+	stk/Stk.cpp stk/SineWave.cpp stk/BiQuad.cpp stk/ADSR.cpp \
+	stk/BlitSaw.cpp stk/Blit.cpp stk/BlitSquare.cpp \
+	stk/Delay.cpp stk/OnePole.cpp stk/Echo.cpp \
+	stk/JCRev.cpp stk/NRev.cpp stk/PRCRev.cpp stk/FreeVerb.cpp \
+	stk/SVFilter.cpp stk/StkArena.cpp \
+	x-api/x-fun.cpp \
+	core/MiSynth.cpp core/MiTuning.cpp \
+	-lpthread
+g++ -std=c++11 -w -D__LITTLE_ENDIAN__ \
+	-Istk/ \
+	-o tests/stkMathAccuracy \
+	tests/stkMathAccuracy.cpp
+g++ -std=c++11 -w -D__LITTLE_ENDIAN__ \
+	-Icore/ -Istk/ -Ix-api/ \
+	-o tests/tuningCheck \
+	tests/tuningCheck.cpp \
+	stk/Stk.cpp stk/StkArena.cpp x-api/x-fun.cpp core/MiTuning.cpp
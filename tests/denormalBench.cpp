@@ -0,0 +1,184 @@
+// denormalBench.cpp
+//
+// CPU per block through long reverb tails, with denormal flushing off and
+// on (see Stk::setDenormalFlush() and Stk::undenormalize()).  A synth plays
+// a note into a long reverb and then renders the tail; each STK reverb is
+// then struck with a short burst and left ringing, without the synth's
+// silence detection to cut it off.  The cost of a block should stay flat
+// all the way through a tail, whichever way flushing is set.
+//
+// build from the top of the tree with tests/compileTests.sh, then run
+//
+//     tests/denormalBench [tail seconds]
+#include "MiSynth.h"
+#include "JCRev.h"
+#include "NRev.h"
+#include "PRCRev.h"
+#include "FreeVerb.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace stk;
+
+#define BENCH_SAMPLE_RATE (44100.0)
+#define BENCH_BLOCK_SIZE 256
+// seconds of tail rendered after the note or burst, unless given
+#define BENCH_TAIL_TIME 30
+// reverb decay (T60 seconds) for the synth and the STK reverbs
+#define BENCH_REVERB_T60 (10.0)
+// seconds between the rows printed
+#define BENCH_REPORT_INTERVAL 5
+
+typedef std::chrono::steady_clock Clock;
+
+//-----------------------------------------------------------------------------
+// name: struct BlockTimes
+// desc: the microseconds each second of tail took per block, average and
+//       worst
+//-----------------------------------------------------------------------------
+struct BlockTimes {
+    std::vector<double> average;
+    std::vector<double> worst;
+};
+
+//-----------------------------------------------------------------------------
+// name: microseconds()
+// desc: microseconds between two clock readings
+//-----------------------------------------------------------------------------
+static double microseconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+//-----------------------------------------------------------------------------
+// name: record()
+// desc: add a block's time to the second of tail it falls in
+//-----------------------------------------------------------------------------
+static void record(BlockTimes& times, long frame, double blockTime) {
+    unsigned int second = (unsigned int)(frame / BENCH_SAMPLE_RATE);
+    if (times.average.size() <= second) {
+        times.average.resize(second + 1, 0.0);
+        times.worst.resize(second + 1, 0.0);
+    }
+    times.average[second] += blockTime * BENCH_BLOCK_SIZE / BENCH_SAMPLE_RATE;
+    if (blockTime > times.worst[second]) times.worst[second] = blockTime;
+}
+
+//-----------------------------------------------------------------------------
+// name: benchSynth()
+// desc: play half a second of a note into a long reverb, then time the
+//       blocks of the tail
+//-----------------------------------------------------------------------------
+static BlockTimes benchSynth(int reverbType, long tailFrames) {
+    MiSynth synth(8);
+    synth.setReverbType(reverbType);
+    synth.setReverbSize(BENCH_REVERB_T60);
+    synth.setReverbMix(1.0);
+
+    StkFrames frames(BENCH_BLOCK_SIZE, 2);
+    synth.noteOn(48, 100);
+    for (long frame = 0; frame < BENCH_SAMPLE_RATE / 2; frame += BENCH_BLOCK_SIZE)
+        synth.tick(frames);
+    synth.noteOff(48);
+
+    BlockTimes times;
+    for (long frame = 0; frame < tailFrames; frame += BENCH_BLOCK_SIZE) {
+        Clock::time_point start = Clock::now();
+        synth.tick(frames);
+        record(times, frame, microseconds(start, Clock::now()));
+    }
+    return times;
+}
+
+//-----------------------------------------------------------------------------
+// name: benchReverb()
+// desc: strike a reverb with a burst of noise, then time the blocks of the
+//       tail as it rings down
+//-----------------------------------------------------------------------------
+template <class R>
+static BlockTimes benchReverb(R& reverb, long tailFrames) {
+    srand(1);
+    for (int i = 0; i < BENCH_BLOCK_SIZE; i++)
+        reverb.tick(rand() / (StkFloat) RAND_MAX - 0.5);
+
+    BlockTimes times;
+    StkFloat sum = 0.0;
+    for (long frame = 0; frame < tailFrames; frame += BENCH_BLOCK_SIZE) {
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < BENCH_BLOCK_SIZE; i++) sum += reverb.tick(0.0);
+        record(times, frame, microseconds(start, Clock::now()));
+    }
+
+    // keep the output live so the ticks can't be optimized away
+    if (sum == 12345.0) printf("\n");
+    return times;
+}
+
+//-----------------------------------------------------------------------------
+// name: report()
+// desc: print the block times of one tail with flushing off and on
+//-----------------------------------------------------------------------------
+static void report(const char* name, const BlockTimes& off, const BlockTimes& on) {
+    printf("\n%s, microseconds per %d frame block\n", name, BENCH_BLOCK_SIZE);
+    printf("  second   flush off avg / worst   flush on avg / worst\n");
+    for (unsigned int second = 0; second < off.average.size(); second++) {
+        if (second % BENCH_REPORT_INTERVAL != 0 && second + 1 != off.average.size()) continue;
+        printf("  %6u   %9.1f / %-9.1f   %8.1f / %-9.1f\n", second,
+               off.average[second], off.worst[second], on.average[second], on.worst[second]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: benchReverbType()
+// desc: time one kind of STK reverb's tail with flushing off and on
+//-----------------------------------------------------------------------------
+template <class R>
+static void benchReverbType(const char* name, long tailFrames) {
+    BlockTimes times[2];
+    for (int flush = 0; flush < 2; flush++) {
+        Stk::setDenormalFlush(flush != 0);
+        R reverb;
+        reverb.setT60(BENCH_REVERB_T60);
+        times[flush] = benchReverb(reverb, tailFrames);
+    }
+    report(name, times[0], times[1]);
+}
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    Stk::setSampleRate(BENCH_SAMPLE_RATE);
+    int tailTime = argc > 1 ? atoi(argv[1]) : BENCH_TAIL_TIME;
+    if (tailTime <= 0) tailTime = BENCH_TAIL_TIME;
+    long tailFrames = (long)(tailTime * BENCH_SAMPLE_RATE);
+
+    const char* synthNames[] = { "MiSynth PRCRev", "MiSynth JCRev", "MiSynth NRev", "MiSynth FreeVerb" };
+    for (int reverbType = PRCREV; reverbType <= FREEREV; reverbType++) {
+        BlockTimes times[2];
+        for (int flush = 0; flush < 2; flush++) {
+            Stk::setDenormalFlush(flush != 0);
+            times[flush] = benchSynth(reverbType, tailFrames);
+        }
+        report(synthNames[reverbType], times[0], times[1]);
+    }
+
+    benchReverbType<PRCRev>("PRCRev", tailFrames);
+    benchReverbType<JCRev>("JCRev", tailFrames);
+    benchReverbType<NRev>("NRev", tailFrames);
+
+    // FreeVerb has no T60, its largest room rings the longest
+    BlockTimes times[2];
+    for (int flush = 0; flush < 2; flush++) {
+        Stk::setDenormalFlush(flush != 0);
+        FreeVerb reverb;
+        reverb.setRoomSize(1.0);
+        times[flush] = benchReverb(reverb, tailFrames);
+    }
+    report("FreeVerb", times[0], times[1]);
+
+    Stk::setDenormalFlush(false);
+    return 0;
+}
@@ -0,0 +1,220 @@
+// stkMathAccuracy.cpp
+//
+// Checks StkMath against long double libm over the ranges its class
+// comment gives, and fails if any function is out of its documented
+// bound.  Also checks that the StkFloat4 and block forms give exactly
+// what the scalar ones do, including for a block that isn't aligned or a
+// multiple of four long.
+//
+// build from the top of the tree with tests/compileTests.sh, then run
+//
+//     tests/stkMathAccuracy
+//
+// it exits non-zero if a check fails.
+#include "StkMath.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace stk;
+
+// random points tried per function
+#define ACCURACY_POINTS 1000000
+// samples in the block tested against the scalar forms, not a multiple of
+// four so the block's scalar tail runs too
+#define ACCURACY_BLOCK_SIZE 1003
+
+// the documented maximum errors (see StkMath.h)
+#define SIN_BOUND (3.4e-12)
+#define TAN_BOUND (4.9e-12)
+#define EXP2_BOUND (1.1e-12)
+#define LOG2_BOUND (2.2e-12)
+#define POW_BOUND(y) (1.1e-12 + 1.5e-12 * fabs(y))
+
+typedef StkFloat (*ScalarForm)(StkFloat);
+typedef void (*FourForm)(const StkFloat4&, StkFloat4&);
+typedef void (*BlockForm)(StkFloat*, unsigned long);
+
+static std::mt19937_64 s_random(1);
+static int s_failures = 0;
+
+//-----------------------------------------------------------------------------
+// name: uniform()
+// desc: a random number in [low, high)
+//-----------------------------------------------------------------------------
+static double uniform(double low, double high) {
+    return std::uniform_real_distribution<double>(low, high)(s_random);
+}
+
+//-----------------------------------------------------------------------------
+// name: report()
+// desc: print a function's worst error against its bound, and count it if
+//       it's over
+//-----------------------------------------------------------------------------
+static void report(const char* name, long double error, double bound, const char* kind) {
+    bool passed = error <= bound;
+    printf("%-5s max %s error %.3Lg (bound %.3g)  %s\n", name, kind, error, bound, passed ? "ok" : "FAILED");
+    if (!passed) s_failures++;
+}
+
+//-----------------------------------------------------------------------------
+// name: checkForms()
+// desc: run the StkFloat4 and block forms of a function over inputs and
+//       check each result is the scalar form's exactly
+//-----------------------------------------------------------------------------
+static void checkForms(const char* name, ScalarForm scalar, FourForm four, BlockForm block,
+                       const std::vector<StkFloat>& inputs) {
+    int mismatches = 0;
+    for (unsigned int i = 0; i + 4 <= inputs.size(); i += 4) {
+        StkFloat4 x = { inputs[i], inputs[i + 1], inputs[i + 2], inputs[i + 3] };
+        StkFloat4 y;
+        four(x, y);
+        for (int lane = 0; lane < 4; lane++)
+            if (y[lane] != scalar(inputs[i + lane])) mismatches++;
+    }
+
+    // one sample in, so the block isn't aligned
+    std::vector<StkFloat> buffer(inputs.size() + 1);
+    for (unsigned int i = 0; i < inputs.size(); i++) buffer[i + 1] = inputs[i];
+    block(&buffer[1], inputs.size());
+    for (unsigned int i = 0; i < inputs.size(); i++)
+        if (buffer[i + 1] != scalar(inputs[i])) mismatches++;
+
+    if (mismatches > 0) {
+        printf("%-5s StkFloat4 or block form differs from the scalar form %d times  FAILED\n", name, mismatches);
+        s_failures++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// name: sinPoint()
+// desc: an argument for sin, cos and tan, |x| < 1e6, half of them small
+//-----------------------------------------------------------------------------
+static double sinPoint(int i) {
+    return uniform(-1.0, 1.0) * (i % 2 ? 10.0 : 1.0e6);
+}
+
+//-----------------------------------------------------------------------------
+// name: log2Point()
+// desc: a positive normal argument for log2
+//-----------------------------------------------------------------------------
+static double log2Point() {
+    return ldexp(uniform(0.5, 1.0), (int) uniform(-1021.0, 1025.0));
+}
+
+//-----------------------------------------------------------------------------
+// name: checkAccuracy()
+// desc: the worst error of each function over its range
+//-----------------------------------------------------------------------------
+static void checkAccuracy() {
+    long double sinError = 0.0, cosError = 0.0, tanError = 0.0;
+    long double exp2Error = 0.0, log2Error = 0.0, powError = 0.0;
+    for (int i = 0; i < ACCURACY_POINTS; i++) {
+        long double x = sinPoint(i);
+        sinError = fmaxl(sinError, fabsl(StkMath::sin((double) x) - sinl(x)));
+        cosError = fmaxl(cosError, fabsl(StkMath::cos((double) x) - cosl(x)));
+
+        // right next to a pole tan is huge and its relative error is x's
+        // rounding magnified, which says nothing about the polynomial
+        long double tangent = tanl(x);
+        if (fabsl(tangent) < 1.0e8)
+            tanError = fmaxl(tanError, fabsl((StkMath::tan((double) x) - tangent) / tangent));
+
+        x = uniform(-1022.0, 1023.0);
+        exp2Error = fmaxl(exp2Error, fabsl((StkMath::exp2((double) x) - exp2l(x)) / exp2l(x)));
+
+        x = log2Point();
+        log2Error = fmaxl(log2Error, fabsl(StkMath::log2((double) x) - log2l(x)));
+
+        // pow's bound grows with y, so measure against it
+        long double base = ldexp(uniform(0.5, 1.0), (int) uniform(-60.0, 61.0));
+        double power = uniform(-8.0, 8.0);
+        long double result = powl(base, power);
+        powError = fmaxl(powError, fabsl((StkMath::pow((double) base, power) - result) / result) / POW_BOUND(power));
+    }
+
+    report("sin", sinError, SIN_BOUND, "absolute");
+    report("cos", cosError, SIN_BOUND, "absolute");
+    report("tan", tanError, TAN_BOUND, "relative");
+    report("exp2", exp2Error, EXP2_BOUND, "relative");
+    report("log2", log2Error, LOG2_BOUND, "absolute");
+
+    // pow's is a fraction of its bound
+    bool passed = powError <= 1.0;
+    printf("pow   max relative error %.3Lg of the bound 1.1e-12 + 1.5e-12 * |y|  %s\n",
+           powError, passed ? "ok" : "FAILED");
+    if (!passed) s_failures++;
+
+    // exp2 is exact at whole numbers
+    int inexact = 0;
+    for (int k = -1022; k <= 1023; k++)
+        if (StkMath::exp2((double) k) != ldexp(1.0, k)) inexact++;
+    printf("exp2  %d whole numbers not exact  %s\n", inexact, inexact == 0 ? "ok" : "FAILED");
+    if (inexact > 0) s_failures++;
+}
+
+//-----------------------------------------------------------------------------
+// name: checkAllForms()
+// desc: the StkFloat4 and block forms of every function against the
+//       scalar ones
+//-----------------------------------------------------------------------------
+static void checkAllForms() {
+    std::vector<StkFloat> angles, powers, positives;
+    for (int i = 0; i < ACCURACY_BLOCK_SIZE; i++) {
+        angles.push_back(sinPoint(i));
+        powers.push_back(uniform(-1022.0, 1023.0));
+        positives.push_back(log2Point());
+    }
+
+    checkForms("sin", static_cast<ScalarForm>(&StkMath::sin), static_cast<FourForm>(&StkMath::sin),
+               static_cast<BlockForm>(&StkMath::sin), angles);
+    checkForms("cos", static_cast<ScalarForm>(&StkMath::cos), static_cast<FourForm>(&StkMath::cos),
+               static_cast<BlockForm>(&StkMath::cos), angles);
+    checkForms("tan", static_cast<ScalarForm>(&StkMath::tan), static_cast<FourForm>(&StkMath::tan),
+               static_cast<BlockForm>(&StkMath::tan), angles);
+    checkForms("exp2", static_cast<ScalarForm>(&StkMath::exp2), static_cast<FourForm>(&StkMath::exp2),
+               static_cast<BlockForm>(&StkMath::exp2), powers);
+    checkForms("log2", static_cast<ScalarForm>(&StkMath::log2), static_cast<FourForm>(&StkMath::log2),
+               static_cast<BlockForm>(&StkMath::log2), positives);
+
+    // pow takes a second argument, so it's checked on its own
+    int mismatches = 0;
+    double power = 1.7;
+    StkFloat4 powers4 = { power, power, power, power };
+    std::vector<StkFloat> bases(ACCURACY_BLOCK_SIZE + 1);
+    for (int i = 0; i < ACCURACY_BLOCK_SIZE; i++) bases[i + 1] = ldexp(uniform(0.5, 1.0), (int) uniform(-60.0, 61.0));
+    for (int i = 0; i + 4 <= ACCURACY_BLOCK_SIZE; i += 4) {
+        StkFloat4 x = { bases[i + 1], bases[i + 2], bases[i + 3], bases[i + 4] };
+        StkFloat4 y;
+        StkMath::pow(x, powers4, y);
+        for (int lane = 0; lane < 4; lane++)
+            if (y[lane] != StkMath::pow(bases[i + 1 + lane], power)) mismatches++;
+    }
+    std::vector<StkFloat> results(bases);
+    StkMath::pow(&results[1], power, ACCURACY_BLOCK_SIZE);
+    for (int i = 1; i <= ACCURACY_BLOCK_SIZE; i++)
+        if (results[i] != StkMath::pow(bases[i], power)) mismatches++;
+    if (mismatches > 0) {
+        printf("pow   StkFloat4 or block form differs from the scalar form %d times  FAILED\n", mismatches);
+        s_failures++;
+    }
+
+    printf("StkFloat4 and block forms checked against the scalar forms\n");
+}
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main() {
+    checkAccuracy();
+    checkAllForms();
+
+    if (s_failures > 0) {
+        printf("%d checks FAILED\n", s_failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,225 @@
+// tuningCheck.cpp
+//
+// Checks MiTuning's tables: equal temperament by default, Scala scales in
+// cents and in ratios, keyboard maps with unmapped keys and notes below the
+// middle note, and bad files being turned down without changing anything.
+// The Scala files are written to the current directory and removed again.
+//
+// build from the top of the tree with tests/compileTests.sh, then run
+//
+//     tests/tuningCheck
+//
+// it exits non-zero if a check fails.  The bad files are reported by
+// MiTuning as they are turned down.
+#include "MiTuning.h"
+#include "x-fun.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace stk;
+
+// how far a frequency worked out through a scale may be from the expected
+// one, relative to it
+#define TUNING_TOLERANCE (1.0e-12)
+
+#define CHECK_SCALE "tuningCheck.scl"
+#define CHECK_MAP "tuningCheck.kbm"
+
+static int s_failures = 0;
+
+//-----------------------------------------------------------------------------
+// name: check()
+// desc: print one check and count it if it failed
+//-----------------------------------------------------------------------------
+static void check(const char* name, bool passed) {
+    printf("%-60s %s\n", name, passed ? "ok" : "FAILED");
+    if (!passed) s_failures++;
+}
+
+//-----------------------------------------------------------------------------
+// name: near()
+// desc: true if a frequency is within TUNING_TOLERANCE of the expected one
+//-----------------------------------------------------------------------------
+static bool near(double frequency, double expected) {
+    return fabs(frequency - expected) <= TUNING_TOLERANCE * expected;
+}
+
+//-----------------------------------------------------------------------------
+// name: writeFile()
+// desc: write a Scala file for the tuning to load
+//-----------------------------------------------------------------------------
+static void writeFile(const char* path, const std::string& contents) {
+    std::ofstream file(path);
+    file << contents;
+}
+
+//-----------------------------------------------------------------------------
+// name: sameTables()
+// desc: true if two tunings map, and tune, every note the same
+//-----------------------------------------------------------------------------
+static bool sameTables(const MiTuning& a, const MiTuning& b) {
+    for (int note = 0; note < TUNING_NOTES; note++) {
+        if (a.isMapped(note) != b.isMapped(note)) return false;
+        if (a.getFrequency(note) != b.getFrequency(note)) return false;
+        if (a.getIncrement(note) != b.getIncrement(note)) return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// name: checkDefault()
+// desc: a new tuning is XFun::midi2freq() exactly, every note mapped
+//-----------------------------------------------------------------------------
+static void checkDefault() {
+    MiTuning tuning;
+    bool same = true;
+    for (int note = 0; note < TUNING_NOTES; note++) {
+        same = same && tuning.isMapped(note)
+                    && tuning.getFrequency(note) == XFun::midi2freq(note)
+                    && tuning.getIncrement(note) == XFun::midi2freq(note) / Stk::sampleRate();
+    }
+    check("default tables are XFun::midi2freq", same);
+}
+
+//-----------------------------------------------------------------------------
+// name: checkScales()
+// desc: twelve degrees in cents give equal temperament back, and a just
+//       scale in ratios puts each degree on its ratio above the tonic
+//-----------------------------------------------------------------------------
+static void checkScales() {
+    MiTuning tuning;
+    writeFile(CHECK_SCALE,
+              "! twelve tone equal temperament\n"
+              "12 tone equal temperament\n"
+              " 12\n!\n"
+              " 100.0\n 200.0\n 300.0\n 400.0\n 500.0\n 600.0\n"
+              " 700.0\n 800.0\n 900.0\n 1000.0\n 1100.0\n 1200.0\n");
+    bool loaded = tuning.loadScale(CHECK_SCALE);
+    bool same = loaded;
+    for (int note = 0; note < TUNING_NOTES; note++)
+        same = same && tuning.isMapped(note) && near(tuning.getFrequency(note), XFun::midi2freq(note));
+    check("12 degree cents scale is equal temperament", same);
+
+    // the tonic sits on note 48 and note 57, degree 9 (5/3), is 440 Hz, so
+    // the tonic is 264 Hz
+    writeFile(CHECK_SCALE,
+              "12 tone just intonation\n"
+              "12\n"
+              "16/15\n9/8\n6/5\n5/4\n4/3\n45/32\n3/2\n8/5\n5/3\n9/5\n15/8\n2/1\n");
+    loaded = tuning.loadScale(CHECK_SCALE);
+    check("ratio scale loads", loaded);
+    check("ratio scale tonic (note 48) is 264 Hz", near(tuning.getFrequency(48), 264.0));
+    check("ratio scale major third (note 52) is 5/4 up", near(tuning.getFrequency(52), 330.0));
+    check("ratio scale fifth (note 55) is 3/2 up", near(tuning.getFrequency(55), 396.0));
+    check("ratio scale reference (note 57) is 440 Hz", near(tuning.getFrequency(57), 440.0));
+    check("ratio scale repeats an octave up (note 60)", near(tuning.getFrequency(60), 528.0));
+    check("ratio scale repeats an octave down (note 36)", near(tuning.getFrequency(36), 132.0));
+    check("ratio scale leading tone below the tonic (note 47) is 15/16",
+          near(tuning.getFrequency(47), 247.5));
+}
+
+//-----------------------------------------------------------------------------
+// name: checkKeyboardMap()
+// desc: a just scale through a map that leaves the black keys out, with the
+//       tonic on note 60 and note 69, degree 9 (5/3), at 440 Hz
+//-----------------------------------------------------------------------------
+static void checkKeyboardMap() {
+    MiTuning tuning;
+    writeFile(CHECK_SCALE,
+              "12 tone just intonation\n"
+              "12\n"
+              "16/15\n9/8\n6/5\n5/4\n4/3\n45/32\n3/2\n8/5\n5/3\n9/5\n15/8\n2/1\n");
+    writeFile(CHECK_MAP,
+              "! white keys only\n"
+              "12\n0\n127\n60\n69\n440.0\n12\n"
+              "! the pattern\n"
+              "0\nx\n2\nx\n4\n5\nx\n7\nx\n9\nx\n11\n");
+    bool loaded = tuning.loadScale(CHECK_SCALE) && tuning.loadKeyboardMap(CHECK_MAP);
+    check("keyboard map loads", loaded);
+
+    bool white = true, black = true;
+    int whiteKeys[] = { 0, 2, 4, 5, 7, 9, 11 };
+    int blackKeys[] = { 1, 3, 6, 8, 10 };
+    for (int octave = 0; octave < 10; octave++) {
+        for (int i = 0; i < 7; i++) white = white && tuning.isMapped(12 * octave + whiteKeys[i]);
+        for (int i = 0; i < 5; i++) black = black && !tuning.isMapped(12 * octave + blackKeys[i]);
+    }
+    check("keys mapped to a degree play", white);
+    check("keys mapped to x are unmapped", black);
+    check("an unmapped key takes the pitch of the key below",
+          tuning.getFrequency(61) == tuning.getFrequency(60));
+
+    // below the middle note the keys fold into the pattern below it, so
+    // note 59 is the last key of that pattern, degree 11 an octave down
+    check("tonic (note 60) is 264 Hz", near(tuning.getFrequency(60), 264.0));
+    check("reference (note 69) is 440 Hz", near(tuning.getFrequency(69), 440.0));
+    check("note 59 is degree 11 an octave down", near(tuning.getFrequency(59), 247.5));
+    check("note 50 is degree 2 an octave down", near(tuning.getFrequency(50), 148.5));
+    check("note 58 (x) is unmapped", !tuning.isMapped(58));
+    check("note 24 is the tonic three octaves down", near(tuning.getFrequency(24), 33.0));
+}
+
+//-----------------------------------------------------------------------------
+// name: checkBadFiles()
+// desc: every bad file is turned down and leaves the tables as they were
+//-----------------------------------------------------------------------------
+static void checkBadFiles() {
+    MiTuning tuning;
+    writeFile(CHECK_SCALE,
+              "12 tone just intonation\n"
+              "12\n"
+              "16/15\n9/8\n6/5\n5/4\n4/3\n45/32\n3/2\n8/5\n5/3\n9/5\n15/8\n2/1\n");
+    tuning.loadScale(CHECK_SCALE);
+    MiTuning before = tuning;
+
+    writeFile(CHECK_SCALE, "no degrees\n0\n");
+    check("scale with zero degrees is turned down", !tuning.loadScale(CHECK_SCALE));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+
+    writeFile(CHECK_SCALE, "too few degrees\n3\n100.0\n200.0\n");
+    check("scale missing degrees is turned down", !tuning.loadScale(CHECK_SCALE));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+
+    writeFile(CHECK_MAP, "0\n0\n127\n60\n128\n440.0\n0\n");
+    check("map with the reference note above 127 is turned down", !tuning.loadKeyboardMap(CHECK_MAP));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+
+    writeFile(CHECK_MAP, "0\n0\n127\n60\n-1\n440.0\n0\n");
+    check("map with the reference note below 0 is turned down", !tuning.loadKeyboardMap(CHECK_MAP));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+
+    writeFile(CHECK_MAP, "0\n0\n127\n200\n69\n440.0\n0\n");
+    check("map with the middle note outside MIDI is turned down", !tuning.loadKeyboardMap(CHECK_MAP));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+
+    writeFile(CHECK_MAP, "3\n0\n127\n60\n69\n440.0\n0\nx\nx\nx\n");
+    check("map with every key unmapped is turned down", !tuning.loadKeyboardMap(CHECK_MAP));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+
+    check("missing file is turned down", !tuning.loadScale("tuningCheck-missing.scl"));
+    check("  and the tables are unchanged", sameTables(tuning, before));
+}
+
+//-----------------------------------------------------------------------------
+// name: main()
+// desc: entry point
+//-----------------------------------------------------------------------------
+int main() {
+    Stk::setSampleRate(44100.0);
+
+    checkDefault();
+    checkScales();
+    checkKeyboardMap();
+    checkBadFiles();
+    remove(CHECK_SCALE);
+    remove(CHECK_MAP);
+
+    if (s_failures > 0) {
+        printf("%d checks FAILED\n", s_failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}